@@ -0,0 +1,382 @@
+//  this file is the benchmark harness for the hot paths: scoring, breeding, piece making, random numbers and whole generations
+#include "Evolve.h"
+#include "PerfCounters.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <thread>
+
+using namespace std;
+
+extern thread_local int PRESSURE_MAGNITUDE;
+
+/*
+USAGE: watchingbench [--reps=N] [--filter=text] [--out=file.json] [--perf]
+
+Every benchmark is run once to warm up and then 'reps' times (5 by default), each repetition doing enough operations to
+take a measurable time. The median repetition gives ns/op and ops/s, the fastest gives min ns/op, and allocations/op
+counts every operator new across the timed repetitions. Results are written as JSON to the file or to the standard
+output, with a table on the standard error.
+
+With --perf, the hardware counters are read around each timed repetition as well, adding cycles, instructions, cache
+misses and branch misses per op, and instructions per cycle. If the system doesn't allow the counters, the JSON says
+why and the benchmarks run without them.
+*/
+
+//  every allocation the harness makes goes through here, so benchmarks can count their own
+static atomic<long> numAllocations(0);
+
+//  the hardware counters, when they're asked for and can be read
+static perfCounters counters;
+
+//  allocates and counts the memory behind every form of new
+static void * countedMalloc(size_t size)
+{
+    numAllocations.fetch_add(1, memory_order_relaxed);
+
+    return malloc(size > 0 ? size : 1);
+}
+
+//  the array, sized and nothrow forms are all replaced along with the plain ones, so every new is counted and every delete
+//  matches the new it frees (none of them are inlined, or g++ would see free() or the plain delete called on memory that
+//  came from a different form of new)
+__attribute__((noinline)) void * operator new(size_t size)
+{
+    void * memory = countedMalloc(size);
+    if (memory == NULL)
+        throw bad_alloc();
+
+    return memory;
+}
+
+__attribute__((noinline)) void * operator new[](size_t size)
+{
+    void * memory = countedMalloc(size);
+    if (memory == NULL)
+        throw bad_alloc();
+
+    return memory;
+}
+
+__attribute__((noinline)) void * operator new(size_t size, const nothrow_t &) noexcept
+{
+    return countedMalloc(size);
+}
+
+__attribute__((noinline)) void * operator new[](size_t size, const nothrow_t &) noexcept
+{
+    return countedMalloc(size);
+}
+
+__attribute__((noinline)) void operator delete(void * memory) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void * memory) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void * memory, size_t) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void * memory, size_t) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void * memory, const nothrow_t &) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void * memory, const nothrow_t &) noexcept
+{
+    free(memory);
+}
+
+//  one benchmark's results
+struct benchResult
+{
+    string mName;
+    long mOpsPerRep;
+    int mReps;
+    double mNsPerOp;
+    double mMinNsPerOp;
+    double mAllocsPerOp;
+
+    //  hardware events per op, in the order of PERF_COUNTER_NAMES, if the counters were read
+    bool mHasEvents;
+    double mEventsPerOp[NUM_PERF_COUNTERS];
+};
+
+//  times 'body', which does 'opsPerRep' operations each time it's called, after an untimed 'setup'
+template <class Setup, class Body>
+benchResult runBench(string name, long opsPerRep, int reps, Setup setup, Body body)
+{
+    setup();
+    body();
+
+    vector<double> nsPerOp;
+    long allocations = 0;
+    int64_t events[NUM_PERF_COUNTERS] = {0};
+
+    for (int i = 0; i < reps; i++)
+    {
+        setup();
+
+        int64_t eventsBefore[NUM_PERF_COUNTERS], eventsAfter[NUM_PERF_COUNTERS];
+        counters.read(eventsBefore);
+
+        long allocationsBefore = numAllocations.load();
+        chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+        body();
+        double nanoseconds = chrono::duration<double, nano>(chrono::steady_clock::now() - startTime).count();
+
+        counters.read(eventsAfter);
+        for (int j = 0; j < NUM_PERF_COUNTERS; j++)
+            events[j] += eventsAfter[j] - eventsBefore[j];
+
+        allocations += numAllocations.load() - allocationsBefore;
+        nsPerOp.push_back(nanoseconds / opsPerRep);
+    }
+
+    sort(nsPerOp.begin(), nsPerOp.end());
+
+    benchResult result;
+    result.mName = name;
+    result.mOpsPerRep = opsPerRep;
+    result.mReps = reps;
+    result.mNsPerOp = nsPerOp[nsPerOp.size() / 2];
+    result.mMinNsPerOp = nsPerOp[0];
+    result.mAllocsPerOp = (double)allocations / ((double)opsPerRep * reps);
+    result.mHasEvents = counters.isOpen();
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+        result.mEventsPerOp[i] = events[i] / ((double)opsPerRep * reps);
+
+    fprintf(stderr, "%-36s %14.1f ns/op %14.0f ops/s %10.2f allocs/op", name.c_str(), result.mNsPerOp, 1e9 / result.mNsPerOp, result.mAllocsPerOp);
+    if (result.mHasEvents && result.mEventsPerOp[PERF_CYCLES] > 0)
+        fprintf(stderr, " %8.2f ipc", result.mEventsPerOp[PERF_INSTRUCTIONS] / result.mEventsPerOp[PERF_CYCLES]);
+    fprintf(stderr, "\n");
+
+    return result;
+}
+
+template <class Body>
+benchResult runBench(string name, long opsPerRep, int reps, Body body)
+{
+    return runBench(name, opsPerRep, reps, []() {}, body);
+}
+
+//  breeds a population for a while with tournaments of three, so evolved genomes can be scored as well as random ones
+static vector<bioClock> evolveClocks(int genomeSize, int numClocks, int numGenerations)
+{
+    MTRand & randGen = simRand();
+    vector<bioClock> population;
+    vector<double> scores;
+
+    for (int i = 0; i < numClocks; i++)
+    {
+        population.push_back(bioClock(genomeSize));
+        scores.push_back(population.back().calcSurvivalScore());
+    }
+
+    for (int i = 0; i < numClocks * numGenerations; i++)
+    {
+        int contestants[3];
+        for (int j = 0; j < 3; j++)
+            contestants[j] = randGen.randInt(numClocks - 1);
+        sort(contestants, contestants + 3, [&scores](int a, int b) {return scores[a] > scores[b];});
+
+        population[contestants[2]] = bioClock(population[contestants[0]], population[contestants[1]]);
+        scores[contestants[2]] = population[contestants[2]].calcSurvivalScore();
+    }
+
+    return population;
+}
+
+int main(int argc, char * argv[])
+{
+    int reps = 5;
+    string filter;
+    string outputPath;
+    bool isCounted = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string argument = argv[i];
+        if (argument.compare(0, 7, "--reps=") == 0)
+            reps = max(1, atoi(argument.c_str() + 7));
+        else if (argument.compare(0, 9, "--filter=") == 0)
+            filter = argument.substr(9);
+        else if (argument.compare(0, 6, "--out=") == 0)
+            outputPath = argument.substr(6);
+        else if (argument == "--perf")
+            isCounted = true;
+        else
+        {
+            cerr << "usage: watchingbench [--reps=N] [--filter=text] [--out=file.json] [--perf]" << endl;
+            return 1;
+        }
+    }
+
+    PRESSURE_MAGNITUDE = varData().mSelectivePressureMagnitude;
+
+    if (isCounted && !counters.open())
+        cerr << "Hardware counters can't be read (" << counters.getError() << "), so the benchmarks run without them" << endl;
+    vector<benchResult> results;
+
+    //  scoring, on random genomes and on genomes that have been bred for a while
+    int genomeSizes[] = {5, 10, 20};
+    for (int g = 0; g < 3; g++)
+    {
+        int genomeSize = genomeSizes[g];
+        long numOps = max(200L, 200000L / (genomeSize * genomeSize));
+
+        vector<bioClock> randomClocks;
+        for (int i = 0; i < 64; i++)
+            randomClocks.push_back(bioClock(genomeSize));
+        vector<bioClock> evolvedClocks = evolveClocks(genomeSize, 64, 30);
+
+        string name = "score_random_g" + to_string(genomeSize);
+        if (name.find(filter) != string::npos)
+            results.push_back(runBench(name, numOps, reps, [&randomClocks, numOps]()
+            {
+                for (long i = 0; i < numOps; i++)
+                    randomClocks[i % randomClocks.size()].calcSurvivalScore();
+            }));
+
+        name = "score_evolved_g" + to_string(genomeSize);
+        if (name.find(filter) != string::npos)
+            results.push_back(runBench(name, numOps, reps, [&evolvedClocks, numOps]()
+            {
+                for (long i = 0; i < numOps; i++)
+                    evolvedClocks[i % evolvedClocks.size()].calcSurvivalScore();
+            }));
+
+        name = "crossover_g" + to_string(genomeSize);
+        if (name.find(filter) != string::npos)
+            results.push_back(runBench(name, numOps, reps, [&evolvedClocks, numOps]()
+            {
+                for (long i = 0; i < numOps; i++)
+                {
+                    bioClock child(evolvedClocks[i % evolvedClocks.size()], evolvedClocks[(i + 1) % evolvedClocks.size()]);
+                    evolvedClocks[(i + 2) % evolvedClocks.size()] = child;
+                }
+            }));
+    }
+
+    //  the small pieces everything else is built from
+    const long NUM_SMALL_OPS = 1000000;
+    if (string("piece_construct").find(filter) != string::npos)
+        results.push_back(runBench("piece_construct", NUM_SMALL_OPS, reps, []()
+        {
+            int types = 0;
+            for (long i = 0; i < NUM_SMALL_OPS; i++)
+            {
+                clockPiece piece;
+                types += piece.getPieceType();
+            }
+            if (types < 0)
+                cerr << types;
+        }));
+
+    if (string("rand_double").find(filter) != string::npos)
+        results.push_back(runBench("rand_double", NUM_SMALL_OPS, reps, []()
+        {
+            MTRand & randGen = simRand();
+            double total = 0;
+            for (long i = 0; i < NUM_SMALL_OPS; i++)
+                total += randGen.rand();
+            if (total < 0)
+                cerr << total;
+        }));
+
+    if (string("rand_int").find(filter) != string::npos)
+        results.push_back(runBench("rand_int", NUM_SMALL_OPS, reps, []()
+        {
+            MTRand & randGen = simRand();
+            unsigned long total = 0;
+            for (long i = 0; i < NUM_SMALL_OPS; i++)
+                total += randGen.randInt(999);
+            if (total == 1)
+                cerr << total;
+        }));
+
+    //  a whole generation of tournaments, with a new world made (untimed) for each repetition
+    int populations[] = {1000, 10000};
+    for (int p = 0; p < 2; p++)
+    {
+        string name = "generation_pop" + to_string(populations[p]);
+        if (name.find(filter) == string::npos)
+            continue;
+
+        varData settings;
+        settings.mPopulationSize = populations[p];
+        settings.mNumGenerations = 1;
+        settings.mShowInterval = 0;
+
+        //  each repetition is one generation of a fresh population
+        unique_ptr<world> simulation;
+        results.push_back(runBench(name, 1, reps, [&settings, &simulation]()
+        {
+            simulation.reset();
+            simulation.reset(new world(settings));
+            simulation->initClocks();
+        },
+        [&simulation]()
+        {
+            simulation->mateClocks();
+        }));
+    }
+
+    //  the results as JSON
+    ofstream outputFile;
+    if (!outputPath.empty())
+    {
+        outputFile.open(outputPath.c_str());
+        if (!outputFile)
+        {
+            cerr << "Can't open '" << outputPath << "'" << endl;
+            return 1;
+        }
+    }
+    ostream & out = outputPath.empty() ? cout : outputFile;
+
+    out << "{\n  \"threads\": " << thread::hardware_concurrency() << ",\n  \"reps\": " << reps << ",\n";
+    if (isCounted)
+    {
+        //  the error comes from strerror(), which has no quotes or backslashes to escape
+        string counterStatus = counters.isOpen() ? "counting" : "unavailable: " + counters.getError();
+        out << "  \"perf\": \"" << counterStatus << "\",\n";
+    }
+    out << "  \"benchmarks\": [\n";
+
+    for (int i = 0; i < (signed int)results.size(); i++)
+    {
+        char line[1024];
+        int length = snprintf(line, sizeof(line), "    {\"name\": \"%s\", \"ops_per_rep\": %ld, \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, \"ops_per_sec\": %.1f, \"allocs_per_op\": %.4f",
+            results[i].mName.c_str(), results[i].mOpsPerRep, results[i].mNsPerOp, results[i].mMinNsPerOp, 1e9 / results[i].mNsPerOp, results[i].mAllocsPerOp);
+
+        if (results[i].mHasEvents)
+        {
+            const double * events = results[i].mEventsPerOp;
+            length += snprintf(line + length, sizeof(line) - length, ", \"cycles_per_op\": %.2f, \"instructions_per_op\": %.2f, \"cache_misses_per_op\": %.4f, \"branch_misses_per_op\": %.4f, \"ipc\": %.3f",
+                events[PERF_CYCLES], events[PERF_INSTRUCTIONS], events[PERF_CACHE_MISSES], events[PERF_BRANCH_MISSES],
+                (events[PERF_CYCLES] > 0) ? events[PERF_INSTRUCTIONS] / events[PERF_CYCLES] : 0.0);
+        }
+
+        snprintf(line + length, sizeof(line) - length, "}%s\n", (i + 1 < (signed int)results.size()) ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+
+    return 0;
+}
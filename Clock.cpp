@@ -1,13 +1,30 @@
 //  this file defines what all of the organism-level functions do
 #include "Clock.h"
 
-extern int * PRESSURE_MAGNITUDE;
+#include <cstring>
+
+extern thread_local int PRESSURE_MAGNITUDE;
+
+//  one generator per thread, made the first time it's asked for
+MTRand & simRand()
+{
+    static thread_local MTRand randGen;
+
+    return randGen;
+}
+
+void seedSimRand(unsigned long seed, int simNumber, int stream)
+{
+    //  the three numbers go in as a seed array, so nearby seeds and simulation numbers still give unrelated sequences
+    MTRand::uint32 seedArray[3] = {(MTRand::uint32)seed, (MTRand::uint32)simNumber, (MTRand::uint32)stream};
+    simRand().seed(seedArray, 3);
+}
 
 //  constructs a random clockpiece
 clockPiece::clockPiece()
 {
-    //  creates an MTRand that can make random numbers
-    MTRand randGen;
+    //  draws from the simulation's random number generator
+    MTRand & randGen = simRand();
 
     //  initialize data
     mPieceType = randGen.randInt(PTYPE_AMT);
@@ -27,43 +44,183 @@ clockPiece::clockPiece()
         mNumTeeth = randGen.randInt(MAX_TEETH - 3) + 3;
 }
 
+//  constructs a piece from stored gene data
+clockPiece::clockPiece(pieceGene gene)
+{
+    mPieceType = gene.mPieceType;
+    mPendulumLength = gene.mPendulumLength;
+    mNumTeeth = gene.mNumTeeth;
+    mPieceInterval = 0;
+    mIsConnected = false;
+    mIsPowered = false;
+    mIsAttToHand = false;
+}
+
+//  returns the heritable data of the piece
+pieceGene clockPiece::getGene()
+{
+    pieceGene gene;
+
+    gene.mPieceType = mPieceType;
+    gene.mNumTeeth = mNumTeeth;
+    gene.mPendulumLength = mPendulumLength;
+
+    return gene;
+}
+
 //  constructor randomly generates the clock genome
-bioClock::bioClock(int genomeSize)
+//  the remembered pieces start out empty, rather than as random pieces that draw random numbers only to be overwritten
+bioClock::bioClock(int genomeSize) : mBestPendulum(NULL_GENE), mGear{NULL_GENE, NULL_GENE, NULL_GENE}
 {
     mGenomeSize = genomeSize;
     mClockGenome.resize(mGenomeSize);
 
     //  initialize survival score
     mSurvivalScore = 0;
+    mIsScored = 0;
 
     //  initialize number of working hands
     mNumHands = 0;
+    mNotNullPieces = 0;
 
     //  fill the genome matrix with randomly constructed clock pieces
     for (int i = 0; i < mGenomeSize; i++)
     {
-        mClockGenome[i].resize(mGenomeSize);
+        mClockGenome[i].reserve(mGenomeSize);
         for (int j = 0; j < mGenomeSize; j++)
         {
             clockPiece tempPiece;
-            mClockGenome[i][j] = tempPiece;
+            mClockGenome[i].push_back(tempPiece);
         }
     }
 }
 
+//  rebuilds a clock from stored gene data
+bioClock::bioClock(int genomeSize, const pieceGene * genome) : mBestPendulum(NULL_GENE), mGear{NULL_GENE, NULL_GENE, NULL_GENE}
+{
+    mGenomeSize = genomeSize;
+    mClockGenome.resize(mGenomeSize);
+
+    //  initialize survival score
+    mSurvivalScore = 0;
+    mIsScored = 0;
+
+    //  initialize number of working hands
+    mNumHands = 0;
+    mNotNullPieces = 0;
+
+    for (int i = 0; i < mGenomeSize; i++)
+    {
+        mClockGenome[i].reserve(mGenomeSize);
+        for (int j = 0; j < mGenomeSize; j++)
+            mClockGenome[i].push_back(clockPiece(genome[i * mGenomeSize + j]));
+    }
+}
+
+//  copies the genome out row by row
+void bioClock::getGenome(pieceGene * genome)
+{
+    for (int i = 0; i < mGenomeSize; i++)
+        for (int j = 0; j < mGenomeSize; j++)
+            genome[i * mGenomeSize + j] = mClockGenome[i][j].getGene();
+}
+
+//  sets the genes of every piece in place
+void bioClock::setGenome(const pieceGene * genome)
+{
+    for (int i = 0; i < mGenomeSize; i++)
+        for (int j = 0; j < mGenomeSize; j++)
+            mClockGenome[i][j] = clockPiece(genome[i * mGenomeSize + j]);
+}
+
+//  the pieces' connection marks go with the old genes, and a zeroed summary is what a new clock starts from
+void bioClock::renew(const pieceGene * genome)
+{
+    clockSummary newborn;
+    memset(&newborn, 0, sizeof(newborn));
+
+    setGenome(genome);
+    setSummary(newborn);
+}
+
+clockSummary bioClock::getSummary()
+{
+    clockSummary summary;
+
+    summary.mSurvivalScore = mSurvivalScore;
+    summary.mPendInterval = mBestPendulum.getPieceInterval();
+    for (int i = 0; i < 3; i++)
+    {
+        summary.mGearInterval[i] = mGear[i].getPieceInterval();
+        summary.mGearHand[i] = mGear[i].getIsAttToHand();
+    }
+    summary.mNumHands = mNumHands;
+    summary.mNotNullPieces = mNotNullPieces;
+    summary.mIsScored = mIsScored;
+
+    return summary;
+}
+
+//  only the intervals and hands of the remembered pieces are ever looked at, so those are all that's set
+void bioClock::setSummary(const clockSummary & summary)
+{
+    mSurvivalScore = summary.mSurvivalScore;
+    mBestPendulum.setPieceInterval(summary.mPendInterval);
+    for (int i = 0; i < 3; i++)
+    {
+        mGear[i].setPieceInterval(summary.mGearInterval[i]);
+        mGear[i].setIsAttToHand(summary.mGearHand[i] != 0);
+    }
+    mNumHands = summary.mNumHands;
+    mNotNullPieces = summary.mNotNullPieces;
+    mIsScored = summary.mIsScored;
+}
+
+//  what the clock kept from its last evaluation is written along with its genes, since scoring it again starts from there
+void bioClock::saveState(ostream & out)
+{
+    clockSummary summary = getSummary();
+    out.write((const char *)&summary, sizeof(summary));
+    out.write((const char *)&mMutationRate, sizeof(mMutationRate));
+
+    //  the genome is only genes, the rest of each piece is worked out again at every evaluation
+    vector<pieceGene> genome(mGenomeSize * mGenomeSize);
+    getGenome(&genome[0]);
+    out.write((const char *)&genome[0], sizeof(pieceGene) * genome.size());
+}
+
+//  reads a clock written by saveState() into one of the same genome size
+bool bioClock::loadState(istream & in)
+{
+    clockSummary summary;
+    in.read((char *)&summary, sizeof(summary));
+    in.read((char *)&mMutationRate, sizeof(mMutationRate));
+
+    vector<pieceGene> genome(mGenomeSize * mGenomeSize);
+    if (!in.read((char *)&genome[0], sizeof(pieceGene) * genome.size()))
+        return false;
+
+    setSummary(summary);
+    setGenome(&genome[0]);
+
+    return true;
+}
+
 // 	a clock can be intialized with source data (parents)
-bioClock::bioClock (bioClock source1, bioClock source2)
+bioClock::bioClock (const bioClock & source1, const bioClock & source2) : mBestPendulum(NULL_GENE), mGear{NULL_GENE, NULL_GENE, NULL_GENE}
 {
-    //  creates an MTRand that can make random numbers
-    MTRand randGen;
+    //  draws from the simulation's random number generator
+    MTRand & randGen = simRand();
     double randNum;
     double remainingPercent;
 
     //  initialize survival score
     mSurvivalScore = 0;
+    mIsScored = 0;
 
     //  initialize number of working hands
     mNumHands = 0;
+    mNotNullPieces = 0;
 
     //  get the genome size from one of the parents (doesn't really matter which one)
     mGenomeSize = source1.mGenomeSize;
@@ -72,30 +229,31 @@ bioClock::bioClock (bioClock source1, bioClock source2)
     //  get mutation rate from a parent (doesn't matter which one)
     mMutationRate = source1.mMutationRate;
 
+    //  calculate remaining percent left after accounting for mutation rate
+    remainingPercent = 1 - (mMutationRate / 100);
+
     //  fill genome with either a random (mutated) gene, or an equal chance of a mother's or father's gene
     for (int i = 0; i < mGenomeSize; i++)
     {
-        mClockGenome[i].resize(mGenomeSize);
+        //  rows are filled piece by piece, so no throwaway random pieces are made first
+        mClockGenome[i].reserve(mGenomeSize);
         for (int j = 0; j < mGenomeSize; j++)
         {
             //  random real number from 0-1
             randNum = randGen.rand();
 
-            //  calculate remaining percent left after accounting for mutation rate
-            remainingPercent = 1 - (mMutationRate / 100);
-
             //  create a random piece upon mutation
             if (randNum > remainingPercent)
             {
                 clockPiece tempPiece;
-                mClockGenome[i][j] = tempPiece;
+                mClockGenome[i].push_back(tempPiece);
             }
             //  otherwise it's split 50/50 for inheritance of traits from mother or father
             //  copy the piece from parent
             else if (randNum > (remainingPercent / 2))
-                mClockGenome[i][j] = source1.mClockGenome[i][j];
+                mClockGenome[i].push_back(source1.mClockGenome[i][j]);
             else
-                mClockGenome[i][j] = source2.mClockGenome[i][j];
+                mClockGenome[i].push_back(source2.mClockGenome[i][j]);
 
             //  reset connection status of copied piece
             mClockGenome[i][j].mIsConnected = false;
@@ -123,7 +281,9 @@ double bioClock::calcSurvivalScore(bool output)
     bool bestPendOnTrain = false;
 
     //  score multiplier
-    const double SCORE_MULTIPLIER = *PRESSURE_MAGNITUDE;
+    const double SCORE_MULTIPLIER = PRESSURE_MAGNITUDE;
+
+    mIsScored = 1;
 
     //  number of times to analyze the clock in loops
     const int TIMES_TO_SCAN = 3;
@@ -541,20 +701,25 @@ double scoreDiff(double num1, double num2)
 }
 
 void bioClock::outputClockInfo()
+{
+    writeClockInfo(cout);
+}
+
+void bioClock::writeClockInfo(ostream & out)
 {
     // set precision to 5 decimal points and create a blank line
-    cout << setprecision(5) << endl;
-
-    //  output data to screen
-    cout << "Pendulum interval   : " << mBestPendulum.getPieceInterval() << endl;
-    cout << "Second-gear interval: " << mGear[INDEX_SEC].getPieceInterval() << endl;
-    cout << "Minute-gear interval: " << mGear[INDEX_MIN].getPieceInterval() << endl;
-    cout << "Hour-gear interval  : " << mGear[INDEX_HR].getPieceInterval() << endl;
-    cout << "Working second-hand : " << mGear[INDEX_SEC].getIsAttToHand() << endl;
-    cout << "Working minute-hand : " << mGear[INDEX_MIN].getIsAttToHand() << endl;
-    cout << "Working hour-hand   : " << mGear[INDEX_HR].getIsAttToHand() << endl;
-    cout << "Total size of clock : " << mNotNullPieces << endl;
-    cout << "Total survival score: " << mSurvivalScore << endl;
+    out << setprecision(5) << endl;
+
+    //  output data
+    out << "Pendulum interval   : " << mBestPendulum.getPieceInterval() << endl;
+    out << "Second-gear interval: " << mGear[INDEX_SEC].getPieceInterval() << endl;
+    out << "Minute-gear interval: " << mGear[INDEX_MIN].getPieceInterval() << endl;
+    out << "Hour-gear interval  : " << mGear[INDEX_HR].getPieceInterval() << endl;
+    out << "Working second-hand : " << mGear[INDEX_SEC].getIsAttToHand() << endl;
+    out << "Working minute-hand : " << mGear[INDEX_MIN].getIsAttToHand() << endl;
+    out << "Working hour-hand   : " << mGear[INDEX_HR].getIsAttToHand() << endl;
+    out << "Total size of clock : " << mNotNullPieces << endl;
+    out << "Total survival score: " << mSurvivalScore << endl;
 }
 
 bool bioClock::isPendOnTrain(int x, int y)
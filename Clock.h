@@ -39,6 +39,48 @@ const int INDEX_HR = 2;
 const double MAX_SCORE = 1000000;
 const double MIN_SCORE = 0.000001;
 
+//  returns the random number generator of the simulation running on this thread
+//  it's seeded from /dev/urandom the first time the thread uses it, and saving and reloading its state repeats a run exactly
+MTRand & simRand();
+
+//  seeds the calling thread's generator for one stream of a seeded run: simulation 'simNumber', and 'stream' for the
+//  parts of it that draw separately (0 for a single world, and the island number plus one for each island)
+void seedSimRand(unsigned long seed, int simNumber, int stream = 0);
+
+//  the heritable data of a single piece, in a plain form that can be copied between processes and files
+struct pieceGene
+{
+    int mPieceType;
+    int mNumTeeth;
+    double mPendulumLength;
+};
+
+//  gene data of an empty piece
+const pieceGene NULL_GENE = {PTYPE_NULL, 0, 0};
+
+//  what a clock keeps from its last evaluation: its score and the parts of it that the statistics and the next evaluation look at
+struct clockSummary
+{
+    double mSurvivalScore;
+
+    //  interval of the best pendulum, and of the second, minute and hour gears
+    double mPendInterval;
+    double mGearInterval[3];
+
+    //  if each of the second, minute and hour gears has a hand
+    int mGearHand[3];
+
+    int mNumHands;
+    int mNotNullPieces;
+
+    //  whether the clock has been evaluated since it was made
+    int mIsScored;
+};
+
+//  mIsScored of a clock that was evaluated as it was born, before anything asked for its score: that evaluation stands in
+//  for the first one asked for, so scoring children early doesn't change how the run goes
+const int SCORED_AT_BIRTH = 2;
+
 //  clockPiece class defines the structure of each clock component. It also represents a 'gene' that fits in the clock genome
 class clockPiece
 {
@@ -87,8 +129,12 @@ public:
 
 	void setIsAttToHand (bool isAttToHand){mIsAttToHand = isAttToHand;};
 
-	//  a constructor randomizes the variables.
+	//  returns the heritable data of the piece
+	pieceGene getGene();
+
+	//  a constructor randomizes the variables, or copies them from stored gene data
 	clockPiece();
+	clockPiece(pieceGene gene);
 };
 
 //  this class represents a clock as an organism, and has a vector of clockPieces representing its genome
@@ -96,8 +142,9 @@ class bioClock
 {
 private:
 
-	//  survival score stores how fit the clock is (higher = better)
+	//  survival score stores how fit the clock is (higher = better), and whether it's been worked out since the clock was made
 	double mSurvivalScore;
+	int mIsScored;
 
 	// 	the user can set the genome size before the simulation
 	int mGenomeSize;
@@ -142,16 +189,44 @@ private:
 	//  checks to see if a spring or hand is bound to exactly one gear
 	bool checkMainspringOrHand(int x, int y);
 
-	//  output clock info
+	//  output clock info to the console
 	void outputClockInfo();
 
 public:
 
 	//  constructs a clock randomly or with parents
 	bioClock (int genomeSize);
-	bioClock (bioClock source1, bioClock source2);
+	bioClock (const bioClock & source1, const bioClock & source2);
+
+	//  constructs a clock from stored gene data (genomeSize * genomeSize genes, row by row)
+	bioClock (int genomeSize, const pieceGene * genome);
+
+	//  copies the clock's genes out row by row (genomeSize * genomeSize genes)
+	void getGenome(pieceGene * genome);
+
+	//  replaces the clock's genes in place, row by row
+	void setGenome(const pieceGene * genome);
+
+	//  replaces the genes and forgets the last evaluation, so the next one scores the clock as if it had just been made
+	void renew(const pieceGene * genome);
+
+	//  reads and sets whether a piece was found connected to the rest of the clock, which is kept between evaluations
+	bool isConnected(int x, int y) {return mClockGenome[x][y].mIsConnected;};
+	void setConnected(int x, int y, bool isConnected) {mClockGenome[x][y].mIsConnected = isConnected;};
+
+	//  returns or replaces what the clock kept from its last evaluation
+	clockSummary getSummary();
+	void setSummary(const clockSummary & summary);
+
+	//  writes the clock info from the last evaluation to a stream
+	void writeClockInfo(ostream & out);
+
+	//  writes and reads everything about the clock in binary, including what it remembers from its last evaluation
+	void saveState(ostream & out);
+	bool loadState(istream & in);
 
 	//  evalutates functionality and accuracy
+	//  referenceClock keeps a frozen copy of this, and scorecheck has to find them matching after any change here
 	double calcSurvivalScore(bool output = false);
 
 	//  setters
@@ -0,0 +1,178 @@
+//  this file defines the genome fingerprints and the diversity estimate
+#include "Diversity.h"
+#include "Reduce.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+//  the cells of a word that differ, each as its lowest bit
+static inline uint64_t differingCells(uint64_t a, uint64_t b)
+{
+    uint64_t differ = a ^ b;
+    return (differ | differ >> 1 | differ >> 2) & CELL_LOW_BITS;
+}
+
+//  the plain version, for any processor
+static int distanceGeneric(const uint64_t * a, const uint64_t * b, int numWords)
+{
+    int distance = 0;
+    for (int i = 0; i < numWords; i++)
+        distance += __builtin_popcountll(differingCells(a[i], b[i]));
+
+    return distance;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+//  the same, with the count done by the popcnt instruction rather than a library call
+__attribute__((target("popcnt"))) static int distancePopcnt(const uint64_t * a, const uint64_t * b, int numWords)
+{
+    int distance = 0;
+    for (int i = 0; i < numWords; i++)
+        distance += __builtin_popcountll(differingCells(a[i], b[i]));
+
+    return distance;
+}
+
+//  4 words at a time: each byte's bits are counted by looking up its two halves in a table of 16, and the bytes' counts
+//  are summed into one count per word, which only has to be added up at the end
+__attribute__((target("avx2,popcnt"))) static int distanceAVX2(const uint64_t * a, const uint64_t * b, int numWords)
+{
+    const __m256i lowBits = _mm256_set1_epi64x((long long)CELL_LOW_BITS);
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+    const __m256i nibbleCounts = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    __m256i totals = _mm256_setzero_si256();
+
+    int i = 0;
+    for (; i + 4 <= numWords; i += 4)
+    {
+        __m256i differ = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i)));
+        __m256i cells = _mm256_and_si256(_mm256_or_si256(differ, _mm256_or_si256(_mm256_srli_epi64(differ, 1), _mm256_srli_epi64(differ, 2))), lowBits);
+
+        __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(cells, lowNibble)),
+            _mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(_mm256_srli_epi16(cells, 4), lowNibble)));
+        totals = _mm256_add_epi64(totals, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+
+    int distance = (int)(_mm256_extract_epi64(totals, 0) + _mm256_extract_epi64(totals, 1) + _mm256_extract_epi64(totals, 2)
+        + _mm256_extract_epi64(totals, 3));
+    for (; i < numWords; i++)
+        distance += __builtin_popcountll(differingCells(a[i], b[i]));
+
+    return distance;
+}
+
+#endif
+
+typedef int (*distanceFunction)(const uint64_t *, const uint64_t *, int);
+
+//  picks the fastest version the processor can run, once
+static distanceFunction chooseDistance()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+        return distanceAVX2;
+    if (__builtin_cpu_supports("popcnt"))
+        return distancePopcnt;
+#endif
+
+    return distanceGeneric;
+}
+
+static const distanceFunction DISTANCE_FUNCTION = chooseDistance();
+
+int fingerprintDistance(const uint64_t * a, const uint64_t * b, int numWords)
+{
+    return DISTANCE_FUNCTION(a, b, numWords);
+}
+
+fingerprintSet::fingerprintSet()
+{
+    mNumGenomes = 0;
+    mNumCells = 0;
+    mNumWords = 0;
+}
+
+void fingerprintSet::resize(long numGenomes, int numCells)
+{
+    mNumGenomes = numGenomes;
+    mNumCells = numCells;
+    mNumWords = (numCells + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    mWords.resize(numGenomes * mNumWords);
+}
+
+void fingerprintSet::pack(long index, const pieceGene * genome)
+{
+    uint64_t * words = &mWords[index * mNumWords];
+
+    for (int i = 0; i < mNumWords; i++)
+        words[i] = 0;
+    for (int i = 0; i < mNumCells; i++)
+        words[i / CELLS_PER_WORD] |= (uint64_t)genome[i].mPieceType << (3 * (i % CELLS_PER_WORD));
+}
+
+int fingerprintSet::distance(long a, long b) const
+{
+    return fingerprintDistance(&mWords[a * mNumWords], &mWords[b * mNumWords], mNumWords);
+}
+
+//  scrambles a number (the finishing steps of splitmix64), so pair k of a generation is drawn from nothing but k and the seed
+static uint64_t mixBits(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+
+    return x ^ (x >> 31);
+}
+
+void calcGeneDiversity(workPool * pool, const fingerprintSet & fingerprints, uint64_t seed, geneDiversity & diversity)
+{
+    long numGenomes = fingerprints.size();
+    diversity.mDiversity = 0;
+    diversity.mNumPairs = 0;
+
+    if (numGenomes < 2 || fingerprints.getNumCells() == 0)
+        return;
+
+    //  the distances are whole numbers, so their sum is the same in any order and on any number of threads
+    long long numPairs = (long long)numGenomes * (numGenomes - 1) / 2;
+    long long total;
+
+    if (numPairs <= DIVERSITY_PAIRS)
+    {
+        //  every pair, a row of the triangle at a time
+        total = reduceBlocks(pool, numGenomes, 0LL,
+            [&fingerprints, numGenomes](long begin, long end, long long & sum)
+            {
+                for (long a = begin; a < end; a++)
+                    for (long b = a + 1; b < numGenomes; b++)
+                        sum += fingerprints.distance(a, b);
+            },
+            [](long long & sum, const long long & block) {sum += block;});
+    }
+    else
+    {
+        numPairs = DIVERSITY_PAIRS;
+        total = reduceBlocks(pool, DIVERSITY_PAIRS, 0LL,
+            [&fingerprints, numGenomes, seed](long begin, long end, long long & sum)
+            {
+                for (long k = begin; k < end; k++)
+                {
+                    //  two different clocks, every pair as likely as any other
+                    uint64_t bits = mixBits(seed * DIVERSITY_PAIRS + k);
+                    long a = (long)(bits % numGenomes);
+                    long b = (long)((a + 1 + mixBits(bits) % (numGenomes - 1)) % numGenomes);
+                    sum += fingerprints.distance(a, b);
+                }
+            },
+            [](long long & sum, const long long & block) {sum += block;});
+    }
+
+    diversity.mDiversity = (double)total / numPairs / fingerprints.getNumCells();
+    diversity.mNumPairs = (double)numPairs;
+}
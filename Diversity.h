@@ -0,0 +1,79 @@
+//  this file contains the genome fingerprints that genetic diversity is measured with, and the diversity estimate
+
+#ifndef DIVERSITY_H_INCLUDED
+#define DIVERSITY_H_INCLUDED
+
+#include "Clock.h"
+#include "Pool.h"
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+/*
+A fingerprint packs a genome's piece types at 3 bits per cell, 21 cells to each 64-bit word with the top bit left clear.
+Two genomes differ at a cell when any of its 3 bits differ, so the Hamming distance between them, the number of cells
+holding different pieces, is found by xoring their words, folding each cell's 3 bits down into its lowest one, and
+counting the bits left. The counting is done 4 words at a time with AVX2 where the processor has it, and with the
+popcnt instruction or plain code where it doesn't, whichever the machine running it supports.
+
+Only the piece types are compared: two gears with different numbers of teeth are the same piece here, since it's the
+layouts that selection converges on, and it's them that say whether a population still has anything left to try.
+*/
+
+//  cells packed into each word, and the lowest bit of every cell in a word
+const int CELLS_PER_WORD = 21;
+const uint64_t CELL_LOW_BITS = 0x1249249249249249ULL;
+
+//  a population whose pairs are no more than this is compared pair by pair, a larger one by this many pairs drawn at random
+const long DIVERSITY_PAIRS = 1 << 16;
+
+//  the diversity columns of the stats files: the mean share of cells that differ between two clocks, and the pairs compared
+const int NUM_DIVERSITY_COLUMNS = 2;
+const char * const DIVERSITY_NAMES[NUM_DIVERSITY_COLUMNS] = {"gene_diversity", "diversity_pairs"};
+
+//  how different the genomes of a population are
+struct geneDiversity
+{
+    //  mean Hamming distance between two clocks, as a share of their cells (0 when every clock has the same layout)
+    double mDiversity;
+
+    //  pairs of clocks it was worked out from
+    double mNumPairs;
+};
+
+//  the fingerprints of a population, one after another
+class fingerprintSet
+{
+private:
+
+    vector<uint64_t> mWords;
+    long mNumGenomes;
+    int mNumCells;
+    int mNumWords;
+
+public:
+
+    fingerprintSet();
+
+    //  makes room for 'numGenomes' fingerprints of 'numCells' cells
+    void resize(long numGenomes, int numCells);
+
+    long size() const {return mNumGenomes;};
+    int getNumCells() const {return mNumCells;};
+
+    //  packs a genome (numCells genes, row by row) into fingerprint 'index'
+    void pack(long index, const pieceGene * genome);
+
+    //  the number of cells where two fingerprints hold different pieces
+    int distance(long a, long b) const;
+};
+
+//  the number of cells that differ between two fingerprints 'numWords' words long
+int fingerprintDistance(const uint64_t * a, const uint64_t * b, int numWords);
+
+//  works out the diversity of a population from its fingerprints, drawing the pairs (when there are too many to compare
+//  them all) from 'seed' alone, so it neither uses nor disturbs the simulation's random numbers
+void calcGeneDiversity(workPool * pool, const fingerprintSet & fingerprints, uint64_t seed, geneDiversity & diversity);
+
+#endif // DIVERSITY_H_INCLUDED
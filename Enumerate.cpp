@@ -0,0 +1,516 @@
+//  this file is the exhaustive enumerator, a tool that scores every clock of a small genome to find the best one there is
+#include "Clock.h"
+#include "Pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+using namespace std;
+
+/*
+USAGE: enumerate [--genome=N] [--teeth=a,b,...] [--lengths=a,b,...] [--selmag=N] [--threads=N]
+
+Scores every clock of an NxN genome (N from 1 to 3, 3 by default) whose gears have one of the given numbers of teeth
+and whose pendulums have one of the given lengths, and prints the best clock and how the scores are spread. The
+teeth go from 3 to 50000 and the lengths from 0 to 1, as random pieces' do, and the defaults (3,60,3600,43200 and
+0.2485,1) include the ones that make a pendulum swing once a second and the time gears turn on time.
+
+Most of that space is never scored, since which pieces are where settles most of a clock's score on its own:
+
+    - a clock whose pieces aren't all connected scores 0, so the layouts of empty and filled cells that don't make one
+      connected shape are skipped before any piece types are put in them
+    - a pendulum's length only counts if it hangs from exactly one piece
+    - a gear's teeth only count if the clock has an escapement and a pendulum that can swing, since no gear turns without
+
+so each layout is only scored for the lengths and teeth that count, and the score stands for every clock that differs
+from it only in the others. Each score is the one a clock gets the first time it's evaluated, as in the simulation, and
+the best clock is the first one found with the best score, walking layouts, pieces and values in order.
+*/
+
+//  the definition the evaluator reads the selective pressure from (the simulation's is in Evolve.cpp)
+thread_local int PRESSURE_MAGNITUDE = 0;
+
+//  largest genome there's time to enumerate: 3x3 is 6^9 layouts, 4x4 would be 6^16
+const int MAX_ENUM_GENOME = 3;
+
+//  occupied cells whose piece types are fixed by a task, so the largest layouts are split among several
+const int TASK_PREFIX_CELLS = 2;
+
+//  the score distribution has a bucket for 0, one for anything below 1, and one for each power of 10 up to the last
+const int NUM_DECADES = 24;
+const int NUM_BUCKETS = NUM_DECADES + 2;
+
+//  what a task (or the whole enumeration) found
+struct enumResult
+{
+    //  layouts given piece types, genomes actually scored, and the clocks of the whole space those scores stand for
+    long long mNumLayouts;
+    long long mNumScored;
+    double mNumCovered;
+
+    //  clocks and scored genomes in each bucket of the distribution
+    double mCovered[NUM_BUCKETS];
+    long long mScored[NUM_BUCKETS];
+
+    //  the best score, how many scored genomes reach it and how many clocks they stand for, and the first genome to reach it
+    double mBestScore;
+    long long mNumBest;
+    double mBestCovered;
+    vector<pieceGene> mBestGenome;
+    clockSummary mBestSummary;
+
+    //  where the best genome comes in the walk, to pick the same one however the tasks are run
+    long long mBestOrder[3];
+};
+
+//  one layout of occupied cells, with the piece types of its first few occupied cells fixed
+struct enumTask
+{
+    int mMask;
+    int mPrefix;
+    int mNumPrefix;
+    double mCost;
+};
+
+static void clearResult(enumResult & result)
+{
+    result.mNumLayouts = 0;
+    result.mNumScored = 0;
+    result.mNumCovered = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        result.mCovered[i] = 0;
+        result.mScored[i] = 0;
+    }
+    result.mBestScore = -1;
+    result.mNumBest = 0;
+    result.mBestCovered = 0;
+    result.mBestGenome.clear();
+    for (int i = 0; i < 3; i++)
+        result.mBestOrder[i] = 0;
+}
+
+static int getBucket(double score)
+{
+    if (score <= 0)
+        return 0;
+    if (score < 1)
+        return 1;
+
+    return 2 + min(NUM_DECADES - 1, (int)log10(score));
+}
+
+//  whether a scored genome comes before the best so far in the walk
+static bool isEarlier(const long long * order, const long long * bestOrder)
+{
+    return lexicographical_compare(order, order + 3, bestOrder, bestOrder + 3);
+}
+
+//  adds a task's results to the total
+static void mergeResult(enumResult & total, const enumResult & part)
+{
+    total.mNumLayouts += part.mNumLayouts;
+    total.mNumScored += part.mNumScored;
+    total.mNumCovered += part.mNumCovered;
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        total.mCovered[i] += part.mCovered[i];
+        total.mScored[i] += part.mScored[i];
+    }
+
+    if (part.mNumBest == 0)
+        return;
+
+    if (part.mBestScore > total.mBestScore || (part.mBestScore == total.mBestScore && isEarlier(part.mBestOrder, total.mBestOrder)))
+    {
+        if (part.mBestScore > total.mBestScore)
+        {
+            total.mNumBest = 0;
+            total.mBestCovered = 0;
+        }
+        total.mBestScore = part.mBestScore;
+        total.mBestGenome = part.mBestGenome;
+        total.mBestSummary = part.mBestSummary;
+        copy(part.mBestOrder, part.mBestOrder + 3, total.mBestOrder);
+    }
+
+    if (part.mBestScore == total.mBestScore)
+    {
+        total.mNumBest += part.mNumBest;
+        total.mBestCovered += part.mBestCovered;
+    }
+}
+
+//  whether the occupied cells of a layout make one connected shape (an empty layout counts, as the evaluator sees it)
+static bool isConnectedLayout(int mask, int genomeSize)
+{
+    if (mask == 0)
+        return true;
+
+    int first = 0;
+    while (!(mask & (1 << first)))
+        first++;
+
+    //  flood the shape from its first cell, one step in each direction at a time
+    int reached = 1 << first;
+    int stack[MAX_ENUM_GENOME * MAX_ENUM_GENOME];
+    int numStacked = 0;
+    stack[numStacked++] = first;
+
+    while (numStacked > 0)
+    {
+        int cell = stack[--numStacked];
+        int x = cell / genomeSize;
+        int y = cell % genomeSize;
+        int neighbours[4] = {(x > 0) ? cell - genomeSize : -1, (x < genomeSize - 1) ? cell + genomeSize : -1,
+            (y > 0) ? cell - 1 : -1, (y < genomeSize - 1) ? cell + 1 : -1};
+
+        for (int i = 0; i < 4; i++)
+            if (neighbours[i] >= 0 && (mask & (1 << neighbours[i])) && !(reached & (1 << neighbours[i])))
+            {
+                reached |= 1 << neighbours[i];
+                stack[numStacked++] = neighbours[i];
+            }
+    }
+
+    return reached == mask;
+}
+
+//  the number of occupied cells next to a cell
+static int countNeighbours(int mask, int cell, int genomeSize)
+{
+    int x = cell / genomeSize;
+    int y = cell % genomeSize;
+
+    return (x > 0 && (mask & (1 << (cell - genomeSize)))) + (x < genomeSize - 1 && (mask & (1 << (cell + genomeSize))))
+        + (y > 0 && (mask & (1 << (cell - 1)))) + (y < genomeSize - 1 && (mask & (1 << (cell + 1))));
+}
+
+//  scores every genome of one task
+static void runTask(const enumTask & task, int genomeSize, const vector<int> & teeth, const vector<double> & lengths, int pressure, enumResult & result)
+{
+    int numCells = genomeSize * genomeSize;
+    vector<int> cells;
+    for (int i = 0; i < numCells; i++)
+        if (task.mMask & (1 << i))
+            cells.push_back(i);
+    int numOccupied = cells.size();
+
+    PRESSURE_MAGNITUDE = pressure;
+    vector<pieceGene> genome(numCells, NULL_GENE);
+    bioClock clock(genomeSize, &genome[0]);
+    clearResult(result);
+
+    //  piece types are counted through like a number, one digit per occupied cell, with the task's first digits fixed
+    vector<int> digits(numOccupied, 0);
+    int prefix = task.mPrefix;
+    for (int i = task.mNumPrefix - 1; i >= 0; i--)
+    {
+        digits[i] = prefix % PTYPE_AMT;
+        prefix /= PTYPE_AMT;
+    }
+
+    vector<int> valueCells, valueDigits;
+
+    while (true)
+    {
+        //  the order of this layout in the walk: its cells, then its piece types
+        long long typeOrder = 0;
+        bool hasEscapement = false;
+        int numPendulums = 0, numGears = 0, numSwinging = 0;
+
+        for (int i = 0; i < numOccupied; i++)
+        {
+            pieceGene & gene = genome[cells[i]];
+            gene = NULL_GENE;
+            gene.mPieceType = digits[i] + 1;
+            typeOrder = typeOrder * PTYPE_AMT + digits[i];
+
+            if (gene.mPieceType == PTYPE_ESCAPEMENT)
+                hasEscapement = true;
+            else if (gene.mPieceType == PTYPE_GEAR)
+            {
+                gene.mNumTeeth = teeth[0];
+                numGears++;
+            }
+            else if (gene.mPieceType == PTYPE_PENDULUM)
+            {
+                gene.mPendulumLength = lengths[0];
+                numPendulums++;
+            }
+        }
+
+        //  the cells whose values count
+        valueCells.clear();
+        for (int i = 0; i < numOccupied; i++)
+            if (genome[cells[i]].mPieceType == PTYPE_PENDULUM && countNeighbours(task.mMask, cells[i], genomeSize) == 1)
+            {
+                valueCells.push_back(cells[i]);
+                numSwinging++;
+            }
+        if (hasEscapement && numSwinging > 0)
+            for (int i = 0; i < numOccupied; i++)
+                if (genome[cells[i]].mPieceType == PTYPE_GEAR)
+                    valueCells.push_back(cells[i]);
+        int numTurning = (signed int)valueCells.size() - numSwinging;
+
+        //  each score stands for every choice of the values that don't count
+        double covered = pow((double)teeth.size(), numGears - numTurning) * pow((double)lengths.size(), numPendulums - numSwinging);
+
+        valueDigits.assign(valueCells.size(), 0);
+        long long valueOrder = 0;
+        result.mNumLayouts++;
+
+        while (true)
+        {
+            for (int i = 0; i < (signed int)valueCells.size(); i++)
+            {
+                pieceGene & gene = genome[valueCells[i]];
+                if (gene.mPieceType == PTYPE_GEAR)
+                    gene.mNumTeeth = teeth[valueDigits[i]];
+                else
+                    gene.mPendulumLength = lengths[valueDigits[i]];
+            }
+
+            clock.renew(&genome[0]);
+            double score = clock.calcSurvivalScore();
+
+            int bucket = getBucket(score);
+            result.mNumScored++;
+            result.mNumCovered += covered;
+            result.mScored[bucket]++;
+            result.mCovered[bucket] += covered;
+
+            long long order[3] = {task.mMask, typeOrder, valueOrder};
+            if (score > result.mBestScore || (score == result.mBestScore && isEarlier(order, result.mBestOrder)))
+            {
+                if (score > result.mBestScore)
+                {
+                    result.mNumBest = 0;
+                    result.mBestCovered = 0;
+                }
+                result.mBestScore = score;
+                result.mBestGenome = genome;
+                result.mBestSummary = clock.getSummary();
+                copy(order, order + 3, result.mBestOrder);
+            }
+            if (score == result.mBestScore)
+            {
+                result.mNumBest++;
+                result.mBestCovered += covered;
+            }
+
+            //  the next choice of values, pendulums' lengths and gears' teeth counted through like the piece types
+            int i = (signed int)valueCells.size() - 1;
+            for (; i >= 0; i--)
+            {
+                int numValues = (genome[valueCells[i]].mPieceType == PTYPE_GEAR) ? teeth.size() : lengths.size();
+                if (++valueDigits[i] < numValues)
+                    break;
+                valueDigits[i] = 0;
+            }
+            if (i < 0)
+                break;
+            valueOrder++;
+        }
+
+        //  the next piece types, leaving the task's fixed ones alone
+        int i = numOccupied - 1;
+        for (; i >= task.mNumPrefix; i--)
+        {
+            if (++digits[i] < PTYPE_AMT)
+                break;
+            digits[i] = 0;
+        }
+        if (i < task.mNumPrefix)
+            break;
+    }
+}
+
+//  reads a comma-separated list of numbers
+static bool parseList(string text, vector<double> & values)
+{
+    stringstream list(text);
+    string item;
+
+    values.clear();
+    while (getline(list, item, ','))
+    {
+        stringstream number(item);
+        double value;
+        if (!(number >> value) || !number.eof() || value < 0)
+            return false;
+        values.push_back(value);
+    }
+
+    return !values.empty();
+}
+
+int main(int argc, char * argv[])
+{
+    int genomeSize = 3;
+    int pressure = 10;
+    int numThreads = 0;
+    vector<double> teethValues, lengths;
+    parseList("3,60,3600,43200", teethValues);
+    parseList("0.2485,1", lengths);
+    bool isValid = true;
+
+    for (int i = 1; i < argc && isValid; i++)
+    {
+        string argument = argv[i];
+        if (argument.compare(0, 9, "--genome=") == 0)
+            genomeSize = atoi(argument.c_str() + 9);
+        else if (argument.compare(0, 8, "--teeth=") == 0)
+            isValid = parseList(argument.substr(8), teethValues);
+        else if (argument.compare(0, 10, "--lengths=") == 0)
+            isValid = parseList(argument.substr(10), lengths);
+        else if (argument.compare(0, 9, "--selmag=") == 0)
+            pressure = atoi(argument.c_str() + 9);
+        else if (argument.compare(0, 10, "--threads=") == 0)
+            numThreads = atoi(argument.c_str() + 10);
+        else
+            isValid = false;
+    }
+
+    if (!isValid)
+    {
+        cerr << "usage: enumerate [--genome=N] [--teeth=a,b,...] [--lengths=a,b,...] [--selmag=N] [--threads=N]" << endl;
+        return 1;
+    }
+
+    vector<int> teeth;
+    for (int i = 0; i < (signed int)teethValues.size(); i++)
+    {
+        teeth.push_back((int)teethValues[i]);
+        isValid = isValid && teeth[i] == teethValues[i] && teeth[i] >= 3 && teeth[i] <= MAX_TEETH;
+    }
+    for (int i = 0; i < (signed int)lengths.size(); i++)
+        isValid = isValid && lengths[i] <= 1;
+
+    if (genomeSize < 1 || genomeSize > MAX_ENUM_GENOME || pressure < 1 || !isValid)
+    {
+        cerr << "enumerate needs a genome size from 1 to " << MAX_ENUM_GENOME << ", a selective pressure of at least 1, "
+            << "whole numbers of teeth from 3 to " << MAX_TEETH << " and lengths from 0 to 1" << endl;
+        return 1;
+    }
+
+    int numCells = genomeSize * genomeSize;
+    int numMasks = 1 << numCells;
+
+    //  every value a piece can take, so a cell can be any of (empty plus) this many pieces
+    double choicesPerCell = (PTYPE_AMT - 2) + teeth.size() + lengths.size();
+
+    //  the layouts that aren't connected all score 0, so they're only counted
+    vector<enumTask> tasks;
+    double disconnected = 0;
+    int numConnected = 0;
+
+    for (int mask = 0; mask < numMasks; mask++)
+    {
+        int numOccupied = __builtin_popcount(mask);
+        if (!isConnectedLayout(mask, genomeSize))
+        {
+            disconnected += pow(choicesPerCell, numOccupied);
+            continue;
+        }
+        numConnected++;
+
+        //  a layout's piece types are split among tasks by the types of its first occupied cells
+        int numPrefix = min(TASK_PREFIX_CELLS, numOccupied);
+        int numPrefixes = (int)pow((double)PTYPE_AMT, numPrefix);
+        for (int prefix = 0; prefix < numPrefixes; prefix++)
+        {
+            enumTask task = {mask, prefix, numPrefix, pow((double)PTYPE_AMT, numOccupied - numPrefix)};
+            tasks.push_back(task);
+        }
+    }
+
+    //  the largest tasks go first so the small ones fill in the gaps at the end
+    stable_sort(tasks.begin(), tasks.end(), [](const enumTask & a, const enumTask & b) {return a.mCost > b.mCost;});
+
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    workPool pool(numThreads);
+    mutex totalLock;
+    enumResult total;
+    clearResult(total);
+
+    for (int i = 0; i < (signed int)tasks.size(); i++)
+    {
+        const enumTask * task = &tasks[i];
+        pool.submit([task, genomeSize, &teeth, &lengths, pressure, &total, &totalLock]()
+        {
+            enumResult result;
+            runTask(*task, genomeSize, teeth, lengths, pressure, result);
+
+            lock_guard<mutex> guard(totalLock);
+            mergeResult(total, result);
+        });
+    }
+    pool.wait();
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    total.mNumCovered += disconnected;
+    total.mCovered[0] += disconnected;
+
+    printf("Genome %dx%d, gear teeth", genomeSize, genomeSize);
+    for (int i = 0; i < (signed int)teeth.size(); i++)
+        printf("%s%d", (i > 0 ? "," : " "), teeth[i]);
+    printf(", pendulum lengths");
+    for (int i = 0; i < (signed int)lengths.size(); i++)
+        printf("%s%g", (i > 0 ? "," : " "), lengths[i]);
+    printf(", selective pressure %d\n", pressure);
+
+    printf("%d of %d layouts are connected; %lld ways of filling them were scored %lld times, standing for %.0f of %.0f clocks\n",
+        numConnected, numMasks, total.mNumLayouts, total.mNumScored, total.mNumCovered, pow(choicesPerCell + 1, numCells));
+    printf("%.3f seconds on %d threads (%.0f scores per second)\n\n", seconds, pool.size(), (seconds > 0) ? total.mNumScored / seconds : 0.);
+
+    //  the best clock, drawn the way the genome file shows them, then its values
+    const char PIECE_LETTERS[] = {' ', 'E', 'M', 'G', 'H', 'P'};
+
+    printf("Best score %.17g, reached by %lld scored genomes standing for %.0f clocks; the first of them:\n", total.mBestScore,
+        total.mNumBest, total.mBestCovered);
+    for (int x = 0; x < genomeSize; x++)
+    {
+        printf("  |");
+        for (int y = 0; y < genomeSize; y++)
+            printf("%c", PIECE_LETTERS[total.mBestGenome[x * genomeSize + y].mPieceType]);
+        printf("|\n");
+    }
+    for (int i = 0; i < numCells; i++)
+    {
+        const pieceGene & gene = total.mBestGenome[i];
+        if (gene.mPieceType == PTYPE_GEAR)
+            printf("  gear at %d,%d: %d teeth\n", i / genomeSize, i % genomeSize, gene.mNumTeeth);
+        else if (gene.mPieceType == PTYPE_PENDULUM)
+            printf("  pendulum at %d,%d: length %g\n", i / genomeSize, i % genomeSize, gene.mPendulumLength);
+    }
+    printf("  pendulum interval %.17g, gear intervals %.17g %.17g %.17g, hands %d, pieces %d\n\n", total.mBestSummary.mPendInterval,
+        total.mBestSummary.mGearInterval[INDEX_SEC], total.mBestSummary.mGearInterval[INDEX_MIN], total.mBestSummary.mGearInterval[INDEX_HR],
+        total.mBestSummary.mNumHands, total.mBestSummary.mNotNullPieces);
+
+    printf("%-16s %20s %10s %14s\n", "score", "clocks", "share", "scored");
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        if (total.mCovered[i] == 0)
+            continue;
+
+        char range[32];
+        if (i == 0)
+            snprintf(range, sizeof(range), "0");
+        else if (i == 1)
+            snprintf(range, sizeof(range), "below 1");
+        else if (i == NUM_BUCKETS - 1)
+            snprintf(range, sizeof(range), "1e%d and up", i - 2);
+        else
+            snprintf(range, sizeof(range), "1e%d to 1e%d", i - 2, i - 1);
+
+        printf("%-16s %20.0f %9.5f%% %14lld\n", range, total.mCovered[i], 100 * total.mCovered[i] / total.mNumCovered, total.mScored[i]);
+    }
+
+    return 0;
+}
@@ -1,112 +1,1001 @@
 //  this file defines all population-level functions
 #include "Evolve.h"
+#include "Island.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
 //  global multiplier that controls magnitude of selective pressures
-int * PRESSURE_MAGNITUDE = new int;
+//  each thread keeps its own, since each world sets it for the thread that runs it
+thread_local int PRESSURE_MAGNITUDE = 0;
+
+//  zero all of the generation totals
+genStats::genStats()
+{
+    mNumClocks = 0;
+    mSurvivalScore = 0;
+    mSurvivalScoreSq = 0;
+    mBestScore = 0;
+    mBestPend = 0;
+    mNotNullPieces = 0;
+    mNumDeadClocks = 0;
+    mNumPendClocks = 0;
+    mNumGearClocks = 0;
+
+    for (int i = 0; i < 3; i++)
+    {
+        mGearInterval[i] = 0;
+        mGearHand[i] = 0;
+        mNumHandClocks[i] = 0;
+    }
+}
+
+//  add another population's totals to these ones
+void genStats::merge(const genStats & other)
+{
+    mNumClocks += other.mNumClocks;
+    mSurvivalScore += other.mSurvivalScore;
+    mSurvivalScoreSq += other.mSurvivalScoreSq;
+    mBestScore = max(mBestScore, other.mBestScore);
+    mBestPend += other.mBestPend;
+    mNotNullPieces += other.mNotNullPieces;
+    mNumDeadClocks += other.mNumDeadClocks;
+    mNumPendClocks += other.mNumPendClocks;
+    mNumGearClocks += other.mNumGearClocks;
+
+    for (int i = 0; i < 3; i++)
+    {
+        mGearInterval[i] += other.mGearInterval[i];
+        mGearHand[i] += other.mGearHand[i];
+        mNumHandClocks[i] += other.mNumHandClocks[i];
+    }
+}
 
 //  construct a world simulation
-world::world(varData worldSettings)
+world::world(varData worldSettings, island * worldIsland)
 {
     //  save set variable ranges to private struct within the class
     mWorldSettings = worldSettings;
+    mIsland = worldIsland;
+
+    //  nothing has been scored yet
+    mBestRecord = 0;
+    mMeanRecord = 0;
+    mStalledGens = 0;
+    mGensRun = 0;
+    mHasOutput = false;
+    mSimNumber = 0;
+    mIsFinished = false;
+    mRunSeconds = 0;
+    mIsCounted = false;
+    mDiversity.mDiversity = 0;
+    mDiversity.mNumPairs = 0;
+    mIsPopulationUnseen = false;
+    clearStats();
 
-    *PRESSURE_MAGNITUDE = worldSettings.mSelectivePressureMagnitude;
+    for (int i = 0; i < 4; i++)
+        mOutputSizes[i] = 0;
+
+    PRESSURE_MAGNITUDE = worldSettings.mSelectivePressureMagnitude;
 }
 
 //  create the vector of clocks
 void world::initClocks()
 {
+    //  migrants come and go between islands, so lineages are only followed in a single world
+    if (mWorldSettings.mLineage && mIsland == NULL)
+        mLineage.start(mWorldSettings.mPopulationSize);
+
+    //  a population kept in a file is made there directly (islands always keep theirs in memory, to pass migrants around)
+    if (mWorldSettings.mPopulationStore && mIsland == NULL)
+    {
+        if (openStore(mStore))
+        {
+            for (int i = 0; i < mWorldSettings.mPopulationSize; i++)
+            {
+                mStore.randomClock(i);
+                double score = scoreNewborn(i);
+                if (mTrace.isOpen())
+                    traceChild(-1, -1, i, mStore.unpack(i), score);
+            }
+            return;
+        }
+
+        cout << endl << "Couldn't make a population store in " << getPath() << ", so the population is kept in memory" << endl;
+    }
+
     //  create each clock and insert it into the vector
     for (int i = 0; i < mWorldSettings.mPopulationSize; i++)
     {
         bioClock tempClock(mWorldSettings.mGenomeSize);
         tempClock.setMutationRate(mWorldSettings.mMutationRate);
         mPopulation.push_back(tempClock);
+
+        double score = scoreNewborn(i);
+        if (mTrace.isOpen())
+            traceChild(-1, -1, i, mPopulation[i], score);
+    }
+}
+
+void world::getGenome(int index, pieceGene * genome)
+{
+    if (mStore.isOpen())
+        mStore.getGenome(index, genome);
+    else
+        mPopulation[index].getGenome(genome);
+}
+
+uint64_t world::calcChecksum()
+{
+    //  64-bit FNV-1a over the clocks in order
+    uint64_t checksum = 14695981039346656037ULL;
+    vector<pieceGene> genome(mWorldSettings.mGenomeSize * mWorldSettings.mGenomeSize);
+
+    for (int i = 0; i < getPopulationSize(); i++)
+    {
+        getGenome(i, &genome[0]);
+        double score = getClockSummary(i).mSurvivalScore;
+
+        const unsigned char * bytes = (const unsigned char *)&genome[0];
+        for (size_t j = 0; j < genome.size() * sizeof(pieceGene); j++)
+            checksum = (checksum ^ bytes[j]) * 1099511628211ULL;
+
+        bytes = (const unsigned char *)&score;
+        for (size_t j = 0; j < sizeof(score); j++)
+            checksum = (checksum ^ bytes[j]) * 1099511628211ULL;
+    }
+
+    return checksum;
+}
+
+void world::traceChild(int parent1, int parent2, int slot, bioClock & child, double score)
+{
+    mTraceChild.resize(mWorldSettings.mGenomeSize * mWorldSettings.mGenomeSize);
+    child.getGenome(&mTraceChild[0]);
+
+    //  clocks of the first generation have no parents, and are written whole
+    if (parent1 < 0)
+    {
+        mTrace.addClock(&mTraceChild[0], score);
+        return;
+    }
+
+    mTraceParent.resize(mTraceChild.size());
+    getGenome(parent1, &mTraceParent[0]);
+    mTrace.addChild(parent1, parent2, slot, &mTraceParent[0], &mTraceChild[0], score);
+}
+
+bool world::openStore(clockStore & store)
+{
+    //  a store for children breeds from the population's, so it shares its tiles
+    return store.open(getPath(), (long)mWorldSettings.mPopulationSize, mWorldSettings.mGenomeSize, mWorldSettings.mPopulationStore == 2,
+        (&store == &mStore) ? NULL : &mStore);
+}
+
+//  fixed point has 32 bits after the point, and takes values under 2^62, so a total of a billion of them still fits
+const double FIXED_POINT_ONE = 4294967296.0;
+const double FIXED_POINT_LIMIT = 4611686018427387904.0;
+
+static __int128 toFixed(double value)
+{
+    double whole = floor(value);
+    return (__int128)whole * (__int128)FIXED_POINT_ONE + (__int128)llround((value - whole) * FIXED_POINT_ONE);
+}
+
+static double fromFixed(__int128 value)
+{
+    return (double)(value >> 32) + (double)(value & 0xFFFFFFFF) / FIXED_POINT_ONE;
+}
+
+//  the values a clock adds to the totals kept in fixed point, returning how many of them it has (a dead clock only has its
+//  score and the score's square)
+static int getFixedValues(const clockSummary & summary, double values[NUM_FIXED_TOTALS])
+{
+    values[0] = summary.mSurvivalScore;
+    values[1] = summary.mSurvivalScore * summary.mSurvivalScore;
+    if (summary.mSurvivalScore == 0)
+        return 2;
+
+    values[2] = summary.mPendInterval;
+    for (int i = 0; i < 3; i++)
+        values[3 + i] = summary.mGearInterval[i];
+
+    return NUM_FIXED_TOTALS;
+}
+
+void world::addFixed(int total, double value, int sign)
+{
+    //  a value too big for fixed point (or not a number at all) leaves the totals to be added up again when they're read
+    if (!(fabs(value) < FIXED_POINT_LIMIT))
+    {
+        mIsFixedLost = true;
+        return;
+    }
+
+    mFixedTotals[total] += sign * toFixed(value);
+}
+
+double world::scoreClock(int index)
+{
+    TIME_PHASE(PHASE_SCORING);
+
+    clockSummary oldSummary = getClockSummary(index);
+
+    //  a clock scored as it was born has had this evaluation already, and only has to be marked as having had it
+    if (oldSummary.mIsScored == SCORED_AT_BIRTH)
+    {
+        setScored(index, 1);
+        return oldSummary.mSurvivalScore;
+    }
+
+    double score = mStore.isOpen() ? mStore.score(index) : mPopulation[index].calcSurvivalScore();
+    updateStats(index, oldSummary);
+
+    return score;
+}
+
+void world::setScored(int index, int isScored)
+{
+    if (mStore.isOpen())
+    {
+        mStore.setScored(index, isScored);
+        return;
+    }
+
+    clockSummary summary = mPopulation[index].getSummary();
+    summary.mIsScored = isScored;
+    mPopulation[index].setSummary(summary);
+}
+
+double world::scoreNewborn(int index)
+{
+    double score = scoreClock(index);
+    setScored(index, SCORED_AT_BIRTH);
+
+    return score;
+}
+
+void world::scoreNewborns()
+{
+    mStore.adviseSequential(true);
+    for (int i = 0; i < getPopulationSize(); i++)
+        if (!getClockSummary(i).mIsScored)
+            scoreNewborn(i);
+
+    //  tournaments reach into the store at random
+    mStore.adviseSequential(false);
+}
+
+void world::countClock(const clockSummary & summary, int sign)
+{
+    //  a clock is scored as soon as it's born or arrives, so the only clock that isn't counted is one on its way in
+    if (!summary.mIsScored)
+        return;
+
+    double values[NUM_FIXED_TOTALS];
+    int numValues = getFixedValues(summary, values);
+    for (int i = 0; i < numValues; i++)
+        addFixed(i, values[i], sign);
+
+    mRunningStats.mNumClocks += sign;
+    if (summary.mSurvivalScore == 0)
+    {
+        mRunningStats.mNumDeadClocks += sign;
+        return;
+    }
+
+    for (int i = 0; i < 3; i++)
+        mRunningStats.mGearHand[i] += sign * summary.mGearHand[i];
+    mRunningStats.mNotNullPieces += sign * summary.mNotNullPieces;
+
+    //  add to whatever sort of clock this is (3h, 2h, 1h, gearTrain, pend)
+    if (summary.mNumHands > 0)
+        mRunningStats.mNumHandClocks[summary.mNumHands - 1] += sign;
+    else if (summary.mGearInterval[INDEX_SEC] > 0 || summary.mGearInterval[INDEX_MIN] > 0 || summary.mGearInterval[INDEX_HR] > 0)
+        mRunningStats.mNumGearClocks += sign;
+    else if (summary.mPendInterval != 0)
+        mRunningStats.mNumPendClocks += sign;
+}
+
+void world::updateStats(int index, const clockSummary & oldSummary)
+{
+    clockSummary newSummary = getClockSummary(index);
+    countClock(oldSummary, -1);
+    countClock(newSummary, 1);
+
+    //  the best score can only be kept up to date cheaply while it goes up
+    if (newSummary.mIsScored && (mBestClock < 0 || newSummary.mSurvivalScore >= mRunningStats.mBestScore) && !mIsBestStale)
+    {
+        mRunningStats.mBestScore = newSummary.mSurvivalScore;
+        mBestClock = index;
+    }
+    else if (index == mBestClock)
+        mIsBestStale = true;
+}
+
+void world::clearStats()
+{
+    mRunningStats = genStats();
+    for (int i = 0; i < NUM_FIXED_TOTALS; i++)
+        mFixedTotals[i] = 0;
+    mIsFixedLost = false;
+
+    mBestClock = -1;
+    mIsBestStale = false;
+}
+
+void world::resetStats()
+{
+    clearStats();
+    mIsBestStale = true;
+
+    for (int i = 0; i < getPopulationSize(); i++)
+        countClock(getClockSummary(i), 1);
+}
+
+void world::prefetchClock(int index)
+{
+    if (mStore.isOpen())
+        mStore.prefetch(index);
+    else
+        __builtin_prefetch(&mPopulation[index]);
+}
+
+void world::runTournament(MTRand & randGen, int & parent1, int & parent2, int & loser)
+{
+    int numContestants = (int)mContestantScores.size();
+    int lastClock = getPopulationSize() - 1;
+
+    //  draw contestants without replacement with a partial Fisher-Yates shuffle of the clock order
+    //  they're all drawn before any is scored, so each can be on its way into the cache while the others are scored
+    {
+        TIME_PHASE(PHASE_SAMPLING);
+        for (int i = 0; i < numContestants; i++)
+        {
+            mSwapIndexes[i] = i + randGen.randInt(lastClock - i);
+            swap(mClockOrder[i], mClockOrder[mSwapIndexes[i]]);
+            prefetchClock(mClockOrder[i]);
+        }
+    }
+
+    // 	retrieve the score of each clock
+    for (int i = 0; i < numContestants; i++)
+        mContestantScores[i] = scoreClock(mClockOrder[i]);
+
+    TIME_PHASE(PHASE_SORTING);
+
+    //  the two best contestants become the parents, earlier draws winning ties
+    int best = 0, second = -1;
+    for (int i = 1; i < numContestants; i++)
+    {
+        if (mContestantScores[i] > mContestantScores[best])
+        {
+            second = best;
+            best = i;
+        }
+        else if (second == -1 || mContestantScores[i] > mContestantScores[second])
+            second = i;
     }
+
+    //  the least accurate of the rest is replaced, later draws losing ties
+    int worst = -1;
+    for (int i = 0; i < numContestants; i++)
+        if (i != best && i != second && (worst == -1 || mContestantScores[i] <= mContestantScores[worst]))
+            worst = i;
+
+    parent1 = mClockOrder[best];
+    parent2 = mClockOrder[second];
+    loser = mClockOrder[worst];
+
+    //  undo the swaps so the clock order is back in sequence for the next draw
+    for (int i = numContestants - 1; i >= 0; i--)
+        swap(mClockOrder[i], mClockOrder[mSwapIndexes[i]]);
+}
+
+void world::breedGeneration(MTRand & randGen)
+{
+    int populationSize = getPopulationSize();
+
+    //  every clock was scored once when it was born, and its parent chance comes from that score
+    mStore.adviseSequential(true);
+    mScores.resize(populationSize);
+    for (int i = 0; i < populationSize; i++)
+        mScores[i] = getClockSummary(i).mIsScored ? getClockSummary(i).mSurvivalScore : scoreClock(i);
+    mStore.adviseSequential(false);
+
+    {
+        TIME_PHASE(PHASE_SORTING);
+        if (mWorldSettings.mSelectionMode == SELECT_RANK)
+        {
+            calcRankWeights(mScores, mWorldSettings.mRankPressure, mWeights);
+            mParentTable.build(mWeights);
+        }
+        else
+            mParentTable.build(mScores);
+    }
+
+    //  the children make up the next generation, so every draw in this one uses the same table
+    //  a stored population breeds into a second store, which then takes its place
+    vector<bioClock> children;
+    if (mStore.isOpen())
+    {
+        if (!mChildStore.isOpen() && !openStore(mChildStore))
+        {
+            cout << endl << "Couldn't make a store for the next generation in " << getPath() << endl;
+            exit(1);
+        }
+    }
+    else
+        children.reserve(populationSize);
+
+    for (int i = 0; i < populationSize; i++)
+    {
+        int parent1, parent2;
+        {
+            TIME_PHASE(PHASE_SAMPLING);
+            parent1 = mParentTable.draw(randGen);
+            parent2 = mParentTable.draw(randGen);
+
+            //  a clock can't mate with itself, unless it's the only one that can mate at all
+            for (int tries = 0; parent2 == parent1 && tries < 8; tries++)
+                parent2 = mParentTable.draw(randGen);
+        }
+
+        {
+            TIME_PHASE(PHASE_CROSSOVER);
+            if (mStore.isOpen())
+                mChildStore.breed(mStore, parent1, parent2, i, mWorldSettings.mMutationRate);
+            else
+                children.push_back(bioClock(mPopulation[parent1], mPopulation[parent2]));
+        }
+
+        //  each child is scored as it's born, which is its first evaluation
+        double childScore;
+        {
+            TIME_PHASE(PHASE_SCORING);
+            childScore = mStore.isOpen() ? mChildStore.score(i) : children.back().calcSurvivalScore();
+        }
+
+        if (mTrace.isOpen())
+            traceChild(parent1, parent2, i, mStore.isOpen() ? mChildStore.unpack(i) : children.back(), childScore);
+        if (mLineage.isStarted())
+            mLineage.addChild(i, parent1, parent2, mGensRun + 1);
+    }
+
+    mLineage.commit();
+
+    if (mStore.isOpen())
+        mStore.swap(mChildStore);
+    else
+        mPopulation.swap(children);
+
+    //  the statistics are counted afresh from the new generation's scores
+    resetStats();
 }
 
 void world::mateClocks()
 {
-    //  create a random number generator
-    MTRand randGen;
-    const int CLOCKS_TO_COMPETE = 3;
-    const int SRC_1 = 0;
-    const int SRC_2 = 1;
-    const int LEAST_ACC = 2;
+    //  draws from the simulation's random number generator
+    MTRand & randGen = simRand();
+
+    //  indexes of the parents and of the clock they replace
+    int parent1, parent2, loser;
+
+    //  set up the tournament, which can't draw more clocks than there are
+    int tournamentSize = min(max(mWorldSettings.mTournamentSize, 3), getPopulationSize());
+    mContestantScores.assign(tournamentSize, 0);
+    mSwapIndexes.assign(tournamentSize, 0);
+    mClockOrder.resize(getPopulationSize());
+
+    //  the statistics count every clock, so a new population is scored before its first generation
+    scoreNewborns();
 
-    //  store indexes and accuracies of relevant clocks
-    int clockIndexes[CLOCKS_TO_COMPETE];
-    double clockScores[CLOCKS_TO_COMPETE];
+    for (int i = 0; i < (signed int)mClockOrder.size(); i++)
+        mClockOrder[i] = i;
 
-    //  temp variables for swapping while sorting
-    int tempIndex;
-    double tempScore;
+    //  the phases are timed from here, the first stats row counting from the start
+    string counterError = startPhaseTiming(isTimed(), mWorldSettings.mPerfCounters != 0);
+    mIsCounted = isTimed() && mWorldSettings.mPerfCounters && counterError.empty();
+    if (!counterError.empty())
+        cout << endl << "Hardware counters can't be read (" << counterError << "), so simulation " << mSimNumber << " is timed without them" << endl;
 
-    //  stores selected clocks, initialized to a value out of array
-    int selectedClocks[CLOCKS_TO_COMPETE - 1] = {-1,-1};
-    int randClock = 0;
+    mRowTimes = THREAD_PHASE_TIMES;
+    mRowTime = chrono::steady_clock::now();
+    mRunTimes = phaseTimes();
+    mRunSeconds = 0;
 
-    //  run through each generation
-    for (int x = 0; x < mWorldSettings.mNumGenerations; x++)
+    //  run through each generation, starting after the last one run before a checkpoint was loaded
+    for (int x = mGensRun; x < mWorldSettings.mNumGenerations; x++)
     {
+        if (mTrace.isOpen())
+            mTrace.addGeneration(x + 1);
+
         //  a generation is defined by x matings in a population of x clocks
-        for (int y = 0; y < mWorldSettings.mPopulationSize; y++)
-        {
-            for (int i = 0; i < CLOCKS_TO_COMPETE; i++)
+        if (mWorldSettings.mSelectionMode != SELECT_TOURNAMENT)
+            breedGeneration(randGen);
+        else
+            for (int y = 0; y < mWorldSettings.mPopulationSize; y++)
             {
-                do
+                runTournament(randGen, parent1, parent2, loser);
+
+                //  rewrite the least accurate clock using source data from the two best ones (the parents)
+                clockSummary loserSummary = getClockSummary(loser);
                 {
-                    randClock = randGen.randInt(mPopulation.size() - 1);
+                    TIME_PHASE(PHASE_CROSSOVER);
+                    if (mStore.isOpen())
+                        mStore.breed(mStore, parent1, parent2, loser, mWorldSettings.mMutationRate);
+                    else
+                        mPopulation[loser] = bioClock(mPopulation[parent1], mPopulation[parent2]);
                 }
-                while (selectedClocks[0] == randClock || selectedClocks[1] == randClock);
+                updateStats(loser, loserSummary);
 
-                if (i != CLOCKS_TO_COMPETE)
-                    selectedClocks[i] = randClock;
+                //  the child is scored as it's born, so the statistics always count the whole population
+                double childScore = scoreNewborn(loser);
 
-                // 	randomly choose a clock index from the population
-                clockIndexes[i] = randClock;
-                // 	retrieve the score of the clock
-                clockScores[i] =  mPopulation[clockIndexes[i]].calcSurvivalScore();
+                if (mTrace.isOpen())
+                    traceChild(parent1, parent2, loser, getClock(loser), childScore);
+                if (mLineage.isStarted())
+                {
+                    mLineage.addChild(loser, parent1, parent2, x + 1);
+                    mLineage.commit();
+                }
             }
+        //  a random clock is picked and scored again every generation, whether or not it's recorded, so what's written out
+        //  can't change the run (scoring a clock again changes what it remembers from the last time)
+        int sampleClock = randGen.randInt(getPopulationSize() - 1);
+        scoreClock(sampleClock);
+
+        //  the console only shows every 'mShowInterval'th generation (never, if it's 0), but the genome file gets them all
+        bool isShown = mWorldSettings.mShowInterval > 0 && (x + 1) % mWorldSettings.mShowInterval == 0;
 
-            //  sort clocks by survival score
-            for (int j = 0; j < CLOCKS_TO_COMPETE; j++)
+        if (isShown || mHasOutput)
+        {
+            TIME_PHASE(PHASE_RECORDING);
+            recordGeneration(sampleClock, isShown);
+        }
+
+        if (isShown && mLineage.isStarted())
+        {
+            lineageNode ancestor;
+            if (mLineage.getPopulationAncestor(ancestor))
+                mConsoleText += "The whole population descends from clock " + to_string(ancestor.mId) + ", born in generation " + to_string(ancestor.mGeneration);
+            else
+                mConsoleText += "The population doesn't share an ancestor yet";
+            mConsoleText += " (" + to_string(mLineage.size()) + " ancestors kept)\n";
+        }
+
+        if (isShown)
+        {
+            //  the whole generation's console output goes out in one piece
+            mConsoleText += "\nThis is generation " + to_string(x + 1) + "\n";
+            sendOutput(cout, mConsoleText);
+        }
+
+        //  islands hand their totals to the coordinator and trade migrants instead of writing the averages themselves
+        genStats stats;
+        {
+            TIME_PHASE(PHASE_AVERAGES);
+            stats = calcGenStats();
+            if (mWorldSettings.mGeneDiversity || mWorldSettings.mMinGeneDiversity > 0)
+                mDiversity = calcDiversity(x);
+        }
+
+        if (mIsland != NULL)
+        {
+            mIsland->postStats(x, stats, mDiversity);
+            if ((x + 1) % mWorldSettings.mMigrationInterval == 0)
             {
-                for (int k = j; k < CLOCKS_TO_COMPETE; k++)
-                {
-                    // 	ensure that the index goes from greatest to least accurate
-                    if (clockScores[j] < clockScores[k])
-                    {
-                        //  if it doesn't, swap the accuracy and index reference
-                        tempScore = clockScores[k];
-                        clockScores[k] = clockScores[j];
-                        clockScores[j] = tempScore;
-
-                        tempIndex = clockIndexes[k];
-                        clockIndexes[k] = clockIndexes[j];
-                        clockIndexes[j] = tempIndex;
-                    }
-                }
+                mIsland->exchangeMigrants(mPopulation);
+                resetStats();
+                scoreNewborns();
+            }
+        }
+        else if (mHasOutput)
+        {
+            {
+                TIME_PHASE(PHASE_AVERAGES);
+                outputGenAverages(stats, x);
+            }
+            if ((x + 1) % STATS_FLUSH_GENS == 0)
+            {
+                sendOutput(fout, mStatsText);
+                if (mWriter.isRunning())
+                    mWriter.flush(fout);
+                else
+                    fout.flush();
+                mBinaryStats.flush();
             }
+        }
 
-            //  rewrite third (least accurate) clock using source data from two other ones (the parents)
-            bioClock childClock (mPopulation[clockIndexes[SRC_1]], mPopulation[clockIndexes[SRC_2]]);
-            mPopulation[clockIndexes[LEAST_ACC]] = childClock;
+        mLastStats = stats;
+        mGensRun = x + 1;
+
+        //  stop early once the population has settled, which an island leaves to the coordinator to judge for all of them
+        if (mIsland != NULL)
+        {
+            if (mIsland->waitForJudgement(x))
+                break;
         }
-        recordGeneration();
-        cout << endl << "This is generation " << x + 1 << endl;
-        outputGenAverages();
+        else
+        {
+            string stopReason = checkConvergence(stats, mDiversity);
+            if (!stopReason.empty())
+            {
+                outputStop(x + 1, stopReason);
+                break;
+            }
+        }
+
+        //  the last generation's checkpoint is saved once the run has ended
+        if (mWorldSettings.mCheckpointInterval > 0 && mGensRun % mWorldSettings.mCheckpointInterval == 0 && mGensRun < mWorldSettings.mNumGenerations)
+            saveCheckpoint();
+    }
+
+    if (mHasOutput && mLineage.isStarted())
+        writeLineage();
+
+    if (mHasOutput && isTimed())
+        writeTimingSummary();
+    startPhaseTiming(false);
+
+    //  a finished simulation's checkpoint tells a resumed run to skip it
+    mIsFinished = true;
+    if (mWorldSettings.mCheckpointInterval > 0)
+        saveCheckpoint();
+}
+
+void world::writeLineage()
+{
+    //  the line of descent is followed back from the clock with the best score it was last given
+    int bestClock = 0;
+    for (int i = 1; i < getPopulationSize(); i++)
+        if (getClockSummary(i).mSurvivalScore > getClockSummary(bestClock).mSurvivalScore)
+            bestClock = i;
+
+    vector<lineageNode> line;
+    mLineage.getLineOfDescent(bestClock, line);
+
+    stringstream lineageName;
+    lineageName << mFileSaveLoc << "sim" << mSimNumber << "_lineage.csv";
+    ofstream lout(lineageName.str().c_str());
+
+    //  the ancestors kept are the ones where lines of the living population meet, written from the oldest down
+    lout << "# line of descent of clock " << bestClock << ", score " << getClockSummary(bestClock).mSurvivalScore
+    << ", after generation " << mGensRun << "\n";
+    lout << "id,generation,second_parent\n";
+    for (int i = (signed int)line.size() - 1; i >= 0; i--)
+    {
+        lout << line[i].mId << "," << line[i].mGeneration << ",";
+        if (line[i].mSecondParentId != NO_PARENT_ID)
+            lout << line[i].mSecondParentId;
+        lout << "\n";
     }
+
+    if (!lout)
+        cout << endl << "Couldn't write " << lineageName.str() << endl;
+}
+
+//  returns the size of a file, or 0 if there isn't one
+static long getFileSize(string path)
+{
+    struct stat fileInfo;
+
+    if (path.empty() || stat(path.c_str(), &fileInfo) != 0)
+        return 0;
+
+    return (long)fileInfo.st_size;
 }
 
-void world::recordGeneration()
+string world::getCheckpointName(int simNumber)
 {
+    stringstream checkpointName;
+    checkpointName << getPath() << "sim" << simNumber << "_checkpoint.bin";
+
+    return checkpointName.str();
+}
 
-    //  choose a random clock from within the population
-    MTRand randGen;
-    int randNum = randGen.randInt((int)mWorldSettings.mPopulationSize - 1);
+void world::saveCheckpoint()
+{
+    //  islands run in processes of their own with nothing to save them together, and a world without output has no simulation number
+    if (mSimNumber == 0 || mIsland != NULL)
+        return;
+
+    //  the output files have to hold everything up to this generation before their sizes are taken
+    if (mHasOutput)
+    {
+        sendOutput(fout, mStatsText);
+        sendOutput(gout, mGenomeText);
+        mBinaryStats.flush();
+        mTrace.flush();
+        if (mWriter.isRunning())
+        {
+            mWriter.flush(fout);
+            mWriter.flush(gout);
+            mWriter.drain();
+        }
+        else
+        {
+            fout.flush();
+            gout.flush();
+        }
+    }
+
+    string checkpointName = getCheckpointName(mSimNumber);
+    string tempName = checkpointName + ".tmp";
+    ofstream out(tempName.c_str(), ios::binary | ios::trunc);
+
+    uint32_t header[4] = {(uint32_t)CHECKPOINT_VERSION, (uint32_t)sizeof(varData), (uint32_t)mSimNumber, (uint32_t)mIsFinished};
+    out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    out.write((const char *)header, sizeof(header));
+    out.write((const char *)&mWorldSettings, sizeof(varData));
+
+    int32_t progress[2] = {mGensRun, mStalledGens};
+    double records[2] = {mBestRecord, mMeanRecord};
+    int64_t outputSizes[4] = {getFileSize(mStatsName), getFileSize(mGenomeName), getFileSize(mBinaryName), getFileSize(mTraceName)};
+    out.write((const char *)progress, sizeof(progress));
+    out.write((const char *)records, sizeof(records));
+    out.write((const char *)&mLastStats, sizeof(genStats));
+    out.write((const char *)outputSizes, sizeof(outputSizes));
+
+    uint32_t numClocks = (uint32_t)getPopulationSize();
+    out.write((const char *)&numClocks, sizeof(numClocks));
+    for (int i = 0; i < (signed int)numClocks; i++)
+        getClock(i).saveState(out);
+
+    if (mWorldSettings.mLineage && mIsland == NULL)
+        mLineage.saveState(out);
+
+    MTRand::uint32 randState[MTRand::SAVE];
+    simRand().save(randState);
+    out.write((const char *)randState, sizeof(randState));
+
+    out.close();
+    if (!out)
+    {
+        mConsoleText += "\nCouldn't save the checkpoint " + tempName + "\n";
+        sendOutput(cout, mConsoleText);
+        unlink(tempName.c_str());
+        return;
+    }
+
+    //  the new checkpoint has to be on the disk before it takes the old one's place
+    int fd = open(tempName.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        fsync(fd);
+        ::close(fd);
+    }
+
+    if (rename(tempName.c_str(), checkpointName.c_str()) != 0)
+    {
+        mConsoleText += "\nCouldn't replace the checkpoint " + checkpointName + "\n";
+        sendOutput(cout, mConsoleText);
+    }
+}
+
+bool world::loadCheckpoint(int simNumber)
+{
+    string checkpointName = getCheckpointName(simNumber);
+    ifstream in(checkpointName.c_str(), ios::binary);
+
+    if (!in)
+        return false;
+
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    uint32_t header[4];
+    in.read(magic, sizeof(magic));
+    in.read((char *)header, sizeof(header));
+
+    if (!in || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || header[0] != (uint32_t)CHECKPOINT_VERSION
+        || header[1] != (uint32_t)sizeof(varData) || header[2] != (uint32_t)simNumber)
+    {
+        cout << endl << checkpointName << " isn't a checkpoint of this simulation, so it starts over" << endl;
+        return false;
+    }
+
+    //  the simulation carries on with the settings it started with, apart from the ones about how it's being run
+    varData settings;
+    in.read((char *)&settings, sizeof(varData));
+    settings.mSimTimes = mWorldSettings.mSimTimes;
+    settings.mShowInterval = mWorldSettings.mShowInterval;
+    settings.mCheckpointInterval = mWorldSettings.mCheckpointInterval;
+    settings.mResume = mWorldSettings.mResume;
+    settings.mPopulationStore = mWorldSettings.mPopulationStore;
+    settings.mQuitFlag = mWorldSettings.mQuitFlag;
+
+    int32_t progress[2];
+    double records[2];
+    genStats lastStats;
+    int64_t outputSizes[4];
+    uint32_t numClocks = 0;
+    in.read((char *)progress, sizeof(progress));
+    in.read((char *)records, sizeof(records));
+    in.read((char *)&lastStats, sizeof(genStats));
+    in.read((char *)outputSizes, sizeof(outputSizes));
+    in.read((char *)&numClocks, sizeof(numClocks));
+
+    //  the clocks are made blank and then filled in, in memory or in a store
+    vector<pieceGene> blankGenome(settings.mGenomeSize * settings.mGenomeSize, NULL_GENE);
+    vector<bioClock> population;
+    clockStore store;
+    bool isStored = settings.mPopulationStore && mIsland == NULL && store.open(getPath(), numClocks, settings.mGenomeSize,
+        settings.mPopulationStore == 2, NULL);
+
+    if (in && numClocks == (uint32_t)settings.mPopulationSize)
+    {
+        if (!isStored)
+            population.reserve(numClocks);
+
+        for (uint32_t i = 0; i < numClocks && in; i++)
+        {
+            if (isStored)
+            {
+                bioClock & clock = store.unpack(i);
+                clock.loadState(in);
+                store.pack(i, clock);
+            }
+            else
+            {
+                population.push_back(bioClock(settings.mGenomeSize, &blankGenome[0]));
+                population.back().loadState(in);
+            }
+        }
+    }
+
+    lineageTree lineage;
+    if (settings.mLineage && mIsland == NULL)
+        lineage.loadState(in);
+
+    MTRand::uint32 randState[MTRand::SAVE];
+    in.read((char *)randState, sizeof(randState));
+
+    if (!in || (!isStored && population.size() != numClocks))
+    {
+        cout << endl << checkpointName << " is cut short, so the simulation starts over" << endl;
+        return false;
+    }
+
+    mWorldSettings = settings;
+    PRESSURE_MAGNITUDE = settings.mSelectivePressureMagnitude;
+    mPopulation.swap(population);
+    mStore.swap(store);
+    mLineage = lineage;
+    mGensRun = progress[0];
+    mStalledGens = progress[1];
+    mBestRecord = records[0];
+    mMeanRecord = records[1];
+    mLastStats = lastStats;
+    mIsFinished = (header[3] != 0);
+    mSimNumber = simNumber;
+
+    //  whole numbers and fixed point add up the same in any order, so counting the clocks again gives the totals the run had
+    resetStats();
+
+    //  output written after the checkpoint is thrown away when the files are reopened, but output it counted on can't be missing
+    setOutputNames(simNumber);
+    string outputNames[4] = {mStatsName, mGenomeName, mBinaryName, mTraceName};
+    for (int i = 0; i < 4; i++)
+    {
+        mOutputSizes[i] = (long)outputSizes[i];
+        if (!mIsFinished && getFileSize(outputNames[i]) < mOutputSizes[i])
+        {
+            cout << endl << outputNames[i] << " is shorter than when " << checkpointName << " was saved, so the simulation starts over" << endl;
+            return false;
+        }
+    }
+
+    simRand().load(randState);
+
+    return true;
+}
+
+void world::sendOutput(ostream & target, string & text)
+{
+    if (mWriter.isRunning())
+        mWriter.write(target, text);
+    else
+    {
+        target.write(text.data(), text.size());
+        text.clear();
+    }
+}
+
+bool hasStoppingCriteria(const varData & settings)
+{
+    return settings.mTargetScore > 0 || settings.mMinDiversity > 0 || settings.mMinGeneDiversity > 0 || settings.mStallWindow > 0;
+}
+
+void world::outputStop(int gensRun, string reason)
+{
+    if (mWorldSettings.mShowInterval > 0)
+    {
+        mConsoleText += "\nStopped after generation " + to_string(gensRun) + ": " + reason + "\n";
+        sendOutput(cout, mConsoleText);
+    }
+    outputComment("stopped after generation " + to_string(gensRun) + ": " + reason);
+}
+
+void world::outputComment(string comment)
+{
+    if (mHasOutput)
+        mStatsText += "# " + comment + "\n";
+}
+
+string world::checkConvergence(const genStats & stats, const geneDiversity & diversity)
+{
+    stringstream reason;
+    double numLiving = stats.mNumClocks - stats.mNumDeadClocks;
+    double meanScore = (numLiving > 0) ? stats.mSurvivalScore / numLiving : 0;
+
+    //  a good enough clock has been found
+    if (mWorldSettings.mTargetScore > 0 && stats.mBestScore >= mWorldSettings.mTargetScore)
+    {
+        reason << "best score " << stats.mBestScore << " reached the target of " << mWorldSettings.mTargetScore;
+        return reason.str();
+    }
+
+    //  the living clocks all score about the same (coefficient of variation of the scores)
+    if (mWorldSettings.mMinDiversity > 0 && numLiving > 1 && meanScore > 0)
+    {
+        double variance = max(0., stats.mSurvivalScoreSq / numLiving - meanScore * meanScore);
+        double diversity = sqrt(variance) / meanScore;
+
+        if (diversity < mWorldSettings.mMinDiversity)
+        {
+            reason << "score diversity " << diversity << " fell below " << mWorldSettings.mMinDiversity;
+            return reason.str();
+        }
+    }
+
+    //  the clocks' layouts have come to be much the same (mean share of cells that differ between two clocks)
+    if (mWorldSettings.mMinGeneDiversity > 0 && diversity.mNumPairs > 0 && diversity.mDiversity < mWorldSettings.mMinGeneDiversity)
+    {
+        reason << "gene diversity " << diversity.mDiversity << " fell below " << mWorldSettings.mMinGeneDiversity;
+        return reason.str();
+    }
+
+    //  neither the best nor the mean score has improved for a whole window
+    if (mWorldSettings.mStallWindow > 0)
+    {
+        bool isImproved = false;
+
+        if (stats.mBestScore > mBestRecord * (1 + CONVERGE_TOLERANCE))
+        {
+            mBestRecord = stats.mBestScore;
+            isImproved = true;
+        }
+        if (meanScore > mMeanRecord * (1 + CONVERGE_TOLERANCE))
+        {
+            mMeanRecord = meanScore;
+            isImproved = true;
+        }
+
+        mStalledGens = isImproved ? 0 : mStalledGens + 1;
+
+        if (mStalledGens >= mWorldSettings.mStallWindow)
+        {
+            reason << "no improvement in " << mStalledGens << " generations";
+            return reason.str();
+        }
+    }
+
+    return "";
+}
+
+void world::recordGeneration(int clockIndex, bool isShown)
+{
+    bioClock & clock = getClock(clockIndex);
+    //  letters which represent each part type
+    const char PIECE_LETTERS[] = {' ', 'E', 'M', 'G', 'H', 'P'};
 
     //  for each row in the genome
     for (int x = 0; x < mWorldSettings.mGenomeSize; x++)
@@ -114,111 +1003,580 @@ void world::recordGeneration()
         //  for each column in the genome
         for (int y = 0; y < mWorldSettings.mGenomeSize; y++)
         {
-            //  get the piece genome data
-            clockPiece outputPiece = mPopulation[randNum].getClockPiece(x, y);
-            outputPiece.getPieceType();
+            //  output genome layout, replacing numeric values with letters which represent the part type
+            char letter = PIECE_LETTERS[clock.getClockPiece(x, y).getPieceType()];
+            if (isShown)
+                mConsoleText += letter;
+            if (mHasOutput)
+                mGenomeText += letter;
+        }
+        if (isShown)
+            mConsoleText += '\n';
+        if (mHasOutput)
+            mGenomeText += '\n';
+    }
+
+    if (isShown)
+    {
+        //	output clock data, formatted the way the console is
+        stringstream clockInfo;
+        clockInfo.copyfmt(cout);
+        clock.writeClockInfo(clockInfo);
+        mConsoleText += clockInfo.str();
+    }
+
+    if (mHasOutput)
+    {
+        mGenomeText += '\n';
+        sendOutput(gout, mGenomeText);
+    }
+}
+
+genStats world::calcGenStats()
+{
+    //  the totals are already up to date, apart from the best score once the clock that had it has lost it
+    if (mIsBestStale)
+    {
+        mRunningStats.mBestScore = 0;
+        mBestClock = -1;
 
-            //  output genome layout to screen, replacing numeric values with letters which represent the part type
-            if (outputPiece.getPieceType() != PTYPE_NULL)
+        for (int i = 0; i < getPopulationSize(); i++)
+        {
+            clockSummary summary = getClockSummary(i);
+            if (summary.mIsScored && (mBestClock < 0 || summary.mSurvivalScore > mRunningStats.mBestScore))
             {
-                if (outputPiece.getPieceType() == PTYPE_ESCAPEMENT)
-                {
-                    cout << "E";
-                    gout << "E";
-                }
-                else if (outputPiece.getPieceType() == PTYPE_GEAR)
-                {
-                    cout << "G";
-                    gout << "G";
-                }
-                else if (outputPiece.getPieceType() == PTYPE_PENDULUM)
-                {
-                    cout << "P";
-                    gout << "P";
-                }
-                else if (outputPiece.getPieceType() == PTYPE_MAINSPRING)
-                {
-                    cout << "M";
-                    gout << "M";
-                }
-                else if (outputPiece.getPieceType() == PTYPE_HAND)
-                {
-                    cout << "H";
-                    gout << "H";
-                }
+                mRunningStats.mBestScore = summary.mSurvivalScore;
+                mBestClock = i;
             }
-            else
+        }
+
+        mIsBestStale = false;
+    }
+
+    //  once a value too big for fixed point has come and gone the totals are short of it, so they're added up again from
+    //  every clock, in fixed point if the big values have all gone since, or else in long double
+    long double sums[NUM_FIXED_TOTALS] = {0};
+    bool isSummed = false;
+    if (mIsFixedLost)
+    {
+        for (int i = 0; i < NUM_FIXED_TOTALS; i++)
+            mFixedTotals[i] = 0;
+        mIsFixedLost = false;
+
+        for (int i = 0; i < getPopulationSize(); i++)
+        {
+            clockSummary summary = getClockSummary(i);
+            if (!summary.mIsScored)
+                continue;
+
+            double values[NUM_FIXED_TOTALS];
+            int numValues = getFixedValues(summary, values);
+            for (int j = 0; j < numValues; j++)
             {
-                cout << " ";
-                gout << " ";
+                addFixed(j, values[j], 1);
+                sums[j] += values[j];
             }
         }
-        cout << endl;
-        gout << endl;
+
+        isSummed = mIsFixedLost;
     }
 
-	//	output clock data
-    mPopulation[randNum].calcSurvivalScore(true);
-    gout << endl;
+    double totals[NUM_FIXED_TOTALS];
+    for (int i = 0; i < NUM_FIXED_TOTALS; i++)
+        totals[i] = isSummed ? (double)sums[i] : fromFixed(mFixedTotals[i]);
+
+    mRunningStats.mSurvivalScore = totals[0];
+    mRunningStats.mSurvivalScoreSq = totals[1];
+    mRunningStats.mBestPend = totals[2];
+    for (int i = 0; i < 3; i++)
+        mRunningStats.mGearInterval[i] = totals[3 + i];
+
+    return mRunningStats;
 }
 
-void world::outputGenAverages()
+string world::checkStats()
 {
+    genStats stats = calcGenStats();
+    genStats counted;
+    long double sums[NUM_FIXED_TOTALS] = {0};
+    int numClocks = getPopulationSize();
 
-    // set precision to 5 decimal points and create a blank line
-   fout << setprecision(5);
+    for (int i = 0; i < numClocks; i++)
+    {
+        clockSummary summary = getClockSummary(i);
+        if (!summary.mIsScored)
+            continue;
 
-    //  declare average counters
-    double bestPend = 0, secGearInterval = 0, minGearInterval = 0, hrGearInterval = 0,
-    avgNotNullPieces = 0, secGearHand = 0, minGearHand = 0, hrGearHand = 0, avgSurvivalScore = 0,
-    numDeadClocks = 0, numPendClocks = 0, numGearClocks = 0, num1HClocks = 0, num2HClocks = 0, num3HClocks = 0;
+        counted.mNumClocks++;
+        double values[NUM_FIXED_TOTALS];
+        int numValues = getFixedValues(summary, values);
+        for (int j = 0; j < numValues; j++)
+            sums[j] += values[j];
 
-    for (int x = 0; x < mWorldSettings.mPopulationSize; x++)
+        if (summary.mSurvivalScore == 0)
+        {
+            counted.mNumDeadClocks++;
+            continue;
+        }
+
+        for (int j = 0; j < 3; j++)
+            counted.mGearHand[j] += summary.mGearHand[j];
+        counted.mNotNullPieces += summary.mNotNullPieces;
+
+        if (summary.mNumHands > 0)
+            counted.mNumHandClocks[summary.mNumHands - 1]++;
+        else if (summary.mGearInterval[INDEX_SEC] > 0 || summary.mGearInterval[INDEX_MIN] > 0 || summary.mGearInterval[INDEX_HR] > 0)
+            counted.mNumGearClocks++;
+        else if (summary.mPendInterval != 0)
+            counted.mNumPendClocks++;
+    }
+
+    stringstream error;
+    if (stats.mNumClocks != numClocks)
+        error << stats.mNumClocks << " of " << numClocks << " clocks are counted; ";
+
+    //  the counts have to be exact, and the totals as close as adding them up in a different order can leave them
+    double runningCounts[] = {stats.mNumClocks, stats.mNumDeadClocks, stats.mNumPendClocks, stats.mNumGearClocks, stats.mNumHandClocks[0],
+        stats.mNumHandClocks[1], stats.mNumHandClocks[2], stats.mGearHand[0], stats.mGearHand[1], stats.mGearHand[2], stats.mNotNullPieces};
+    double recounts[] = {counted.mNumClocks, counted.mNumDeadClocks, counted.mNumPendClocks, counted.mNumGearClocks, counted.mNumHandClocks[0],
+        counted.mNumHandClocks[1], counted.mNumHandClocks[2], counted.mGearHand[0], counted.mGearHand[1], counted.mGearHand[2], counted.mNotNullPieces};
+    for (int i = 0; i < (int)(sizeof(recounts) / sizeof(recounts[0])); i++)
+        if (runningCounts[i] != recounts[i])
+            error << "count " << i << " is " << runningCounts[i] << " instead of " << recounts[i] << "; ";
+
+    double runningTotals[NUM_FIXED_TOTALS] = {stats.mSurvivalScore, stats.mSurvivalScoreSq, stats.mBestPend, stats.mGearInterval[0],
+        stats.mGearInterval[1], stats.mGearInterval[2]};
+    for (int i = 0; i < NUM_FIXED_TOTALS; i++)
+        if (!(fabsl(runningTotals[i] - sums[i]) <= 1e-9 * max(1.0L, fabsl(sums[i]))))
+            error << "total " << i << " is " << runningTotals[i] << " instead of " << (double)sums[i] << "; ";
+
+    return error.str();
+}
+
+//  threads score distributions are worked out on, shared by every world the process runs (made the first time it's
+//  needed, and only with more than one core)
+static workPool * getStatsPool()
+{
+    static mutex madeLock;
+    static unique_ptr<workPool> statsPool;
+    static pid_t madeBy = 0;
+
+    //  a process forked for an island inherits the pool but not its threads, so it makes its own, leaving the inherited one
+    //  alone (waiting on it would wait forever, and stopping it would wait for threads that aren't there)
+    lock_guard<mutex> guard(madeLock);
+    if (madeBy != getpid())
     {
-        //  for each clock, recalculate score and add up averages
-        avgSurvivalScore += mPopulation[x].calcSurvivalScore();
-        if (mPopulation[x].getSurvivalScore() != 0)
+        statsPool.release();
+        if (thread::hardware_concurrency() > 1)
+            statsPool.reset(new workPool());
+        madeBy = getpid();
+    }
+
+    return statsPool.get();
+}
+
+scoreDistribution world::calcDistribution()
+{
+    scoreDistribution distribution;
+    calcScoreDistribution(getStatsPool(), getPopulationSize(), [this](long index, double & score)
+    {
+        clockSummary summary = getClockSummary(index);
+        score = summary.mSurvivalScore;
+        return summary.mIsScored != 0;
+    }, distribution);
+
+    return distribution;
+}
+
+geneDiversity world::calcDiversity(int generation)
+{
+    int numCells = mWorldSettings.mGenomeSize * mWorldSettings.mGenomeSize;
+    long numClocks = getPopulationSize();
+    mFingerprints.resize(numClocks, numCells);
+
+    //  clocks are packed block by block, each block copying its genes out through its own buffer
+    reduceBlocks(getStatsPool(), numClocks, 0, [this, numCells](long begin, long end, int &)
+    {
+        vector<pieceGene> genome(numCells);
+        for (long i = begin; i < end; i++)
         {
-            bestPend += mPopulation[x].getBestPendulum().getPieceInterval() ;
-            secGearInterval+= mPopulation[x].getTimeGear(INDEX_SEC).getPieceInterval();
-            minGearInterval+= mPopulation[x].getTimeGear(INDEX_MIN).getPieceInterval();
-            hrGearInterval+= mPopulation[x].getTimeGear(INDEX_HR).getPieceInterval();
-            secGearHand += mPopulation[x].getTimeGear(INDEX_SEC).getIsAttToHand();
-            minGearHand += mPopulation[x].getTimeGear(INDEX_MIN).getIsAttToHand();
-            hrGearHand+= mPopulation[x].getTimeGear(INDEX_HR).getIsAttToHand();
-            avgNotNullPieces += mPopulation[x].getNotNullPieces();
+            getGenome(i, &genome[0]);
+            mFingerprints.pack(i, &genome[0]);
         }
-        numDeadClocks += (mPopulation[x].getSurvivalScore() == 0);
+    },
+    [](int &, const int &) {});
+
+    geneDiversity diversity;
+    calcGeneDiversity(getStatsPool(), mFingerprints, generation, diversity);
+
+    return diversity;
+}
+
+void world::setPopulationUnseen()
+{
+    mIsPopulationUnseen = true;
+    mDiversity.mDiversity = numeric_limits<double>::quiet_NaN();
+    mDiversity.mNumPairs = numeric_limits<double>::quiet_NaN();
+}
 
-        //  add to whatever sort of clock this is (3h, 2h, 1h, gearTrain, pend)
-        if (mPopulation[x].getNumHands() == 3)
-            num3HClocks++;
-        else if (mPopulation[x].getNumHands() == 2)
-            num2HClocks++;
-        else if (mPopulation[x].getNumHands() == 1)
-            num1HClocks++;
-        else if (mPopulation[x].hasGearTrain())
-            numGearClocks++;
-        else if (mPopulation[x].getBestPendulum().getPieceInterval() != 0)
-            numPendClocks++;
+void world::outputGenAverages(genStats stats, int generation)
+{
+    scoreDistribution distribution;
+    if (mWorldSettings.mScoreDistribution && mIsPopulationUnseen)
+    {
+        distribution.mBestClock = numeric_limits<double>::quiet_NaN();
+        fill_n(distribution.mQuantiles, NUM_SCORE_QUANTILES, numeric_limits<double>::quiet_NaN());
+        fill_n(distribution.mBins, NUM_SCORE_BINS, numeric_limits<double>::quiet_NaN());
+    }
+    else if (mWorldSettings.mScoreDistribution)
+        distribution = calcDistribution();
+
+    double timings[NUM_TIMING_COLUMNS];
+    if (isTimed())
+        takeTimingColumns(timings);
 
+    //  the binary file keeps every value at full precision
+    if (mBinaryStats.isOpen())
+    {
+        double values[NUM_GEN_AVERAGES + 2 + NUM_DISTRIBUTION_COLUMNS + NUM_DIVERSITY_COLUMNS + NUM_TIMING_COLUMNS];
+
+        values[0] = generation + 1;
+        calcGenAverages(stats, values + 1);
+        values[NUM_GEN_AVERAGES + 1] = stats.mBestScore;
+
+        int numValues = NUM_GEN_AVERAGES + 2;
+        if (mWorldSettings.mScoreDistribution)
+        {
+            getDistributionColumns(distribution, values + numValues);
+            numValues += NUM_DISTRIBUTION_COLUMNS;
+        }
+        if (mWorldSettings.mGeneDiversity)
+        {
+            values[numValues++] = mDiversity.mDiversity;
+            values[numValues++] = mDiversity.mNumPairs;
+        }
+        if (isTimed())
+            copy(timings, timings + NUM_TIMING_COLUMNS, values + numValues);
+        mBinaryStats.addRow(values);
     }
 
-    //  divide out all of the averages
-    avgSurvivalScore /= mWorldSettings.mPopulationSize - numDeadClocks;
-    bestPend /= mWorldSettings.mPopulationSize - numDeadClocks;
-    secGearInterval /= mWorldSettings.mPopulationSize - numDeadClocks;
-    minGearInterval /= mWorldSettings.mPopulationSize - numDeadClocks;
-    hrGearInterval /= mWorldSettings.mPopulationSize - numDeadClocks;
-    secGearHand /= mWorldSettings.mPopulationSize - numDeadClocks;
-    minGearHand /= mWorldSettings.mPopulationSize - numDeadClocks;
-    hrGearHand /= mWorldSettings.mPopulationSize - numDeadClocks;
-    avgNotNullPieces /= mWorldSettings.mPopulationSize - numDeadClocks;
+    if (!fout.is_open())
+        return;
+
+    char row[GEN_AVERAGES_ROW_SIZE + DISTRIBUTION_ROW_SIZE + DIVERSITY_ROW_SIZE + TIMING_ROW_SIZE + 1];
+    int length = formatGenAverages(row, stats);
+    if (mWorldSettings.mScoreDistribution)
+        length += formatDistribution(row + length, distribution);
+    if (mWorldSettings.mGeneDiversity)
+        length += formatDiversity(row + length, mDiversity);
+    if (isTimed())
+        length += formatTimings(row + length, timings);
 
+    //  rows are gathered into batches before they're handed over to be written
+    row[length++] = '\n';
+    mStatsText.append(row, length);
+
+    if (mStatsText.size() >= WRITER_BATCH_SIZE)
+        sendOutput(fout, mStatsText);
+}
+
+void calcGenAverages(const genStats & stats, double * averages)
+{
+    //  averages are taken over the living clocks only
+    double numLiving = stats.mNumClocks - stats.mNumDeadClocks;
+
+    averages[0] = stats.mBestPend / numLiving;
+    averages[1] = stats.mGearInterval[INDEX_SEC] / numLiving;
+    averages[2] = stats.mGearInterval[INDEX_MIN] / numLiving;
+    averages[3] = stats.mGearInterval[INDEX_HR] / numLiving;
+    averages[4] = stats.mGearHand[INDEX_SEC] / numLiving;
+    averages[5] = stats.mGearHand[INDEX_MIN] / numLiving;
+    averages[6] = stats.mGearHand[INDEX_HR] / numLiving;
+    averages[7] = stats.mNotNullPieces / numLiving;
+    averages[8] = stats.mSurvivalScore / numLiving;
+    averages[9] = stats.mNumDeadClocks;
+    averages[10] = stats.mNumPendClocks;
+    averages[11] = stats.mNumGearClocks;
+    averages[12] = stats.mNumHandClocks[0];
+    averages[13] = stats.mNumHandClocks[1];
+    averages[14] = stats.mNumHandClocks[2];
+}
+
+int formatGenAverages(char * row, const genStats & stats)
+{
+    double averages[NUM_GEN_AVERAGES];
+    calcGenAverages(stats, averages);
+
+    //  5 significant digits, the same as setprecision(5) gives, without going through a stream
+    char * end = row;
+    for (int i = 0; i < NUM_GEN_AVERAGES; i++)
+    {
+        if (i > 0)
+            *end++ = ',';
+        end = to_chars(end, row + GEN_AVERAGES_ROW_SIZE, averages[i], chars_format::general, 5).ptr;
+    }
+
+    return (int)(end - row);
+}
+
+void getDistributionColumns(const scoreDistribution & distribution, double * columns)
+{
+    columns[0] = distribution.mBestClock;
+    for (int i = 0; i < NUM_SCORE_QUANTILES; i++)
+        columns[1 + i] = distribution.mQuantiles[i];
+    for (int i = 0; i < NUM_SCORE_BINS; i++)
+        columns[1 + NUM_SCORE_QUANTILES + i] = distribution.mBins[i];
+}
+
+int formatDistribution(char * row, const scoreDistribution & distribution)
+{
+    double columns[NUM_DISTRIBUTION_COLUMNS];
+    getDistributionColumns(distribution, columns);
+
+    char * end = row;
+    for (int i = 0; i < NUM_DISTRIBUTION_COLUMNS; i++)
+    {
+        *end++ = ',';
+        end = to_chars(end, row + DISTRIBUTION_ROW_SIZE, columns[i], chars_format::general, 5).ptr;
+    }
+
+    return (int)(end - row);
+}
+
+int formatDiversity(char * row, const geneDiversity & diversity)
+{
+    double columns[NUM_DIVERSITY_COLUMNS] = {diversity.mDiversity, diversity.mNumPairs};
+
+    char * end = row;
+    for (int i = 0; i < NUM_DIVERSITY_COLUMNS; i++)
+    {
+        *end++ = ',';
+        end = to_chars(end, row + DIVERSITY_ROW_SIZE, columns[i], chars_format::general, 5).ptr;
+    }
+
+    return (int)(end - row);
+}
+
+void world::takeTimingColumns(double * columns)
+{
+    //  the row is taken while the averages are still being written, so the rest of that is counted in the next row
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    phaseTimes times = THREAD_PHASE_TIMES - mRowTimes;
+    double seconds = chrono::duration<double>(now - mRowTime).count();
+
+    mRowTimes = THREAD_PHASE_TIMES;
+    mRowTime = now;
+    mRunTimes += times;
+    mRunSeconds += seconds;
+
+    for (int i = 0; i < NUM_PHASES; i++)
+        columns[i] = times.mNanoseconds[i] / 1e6;
+    columns[NUM_PHASES] = seconds * 1e3;
+    columns[NUM_PHASES + 1] = (seconds > 0) ? times.mCounts[PHASE_SCORING] / seconds : 0;
+    columns[NUM_PHASES + 2] = (seconds > 0) ? times.mCounts[PHASE_CROSSOVER] / seconds : 0;
+}
+
+void world::writeTimingSummary()
+{
+    if (!fout.is_open() || mRunSeconds <= 0)
+        return;
+
+    char line[256];
+    snprintf(line, sizeof(line), "# timing: %.1f ms over the generations written, %.0f evaluations/s, %.0f matings/s\n", mRunSeconds * 1e3,
+        mRunTimes.mCounts[PHASE_SCORING] / mRunSeconds, mRunTimes.mCounts[PHASE_CROSSOVER] / mRunSeconds);
+    mStatsText += line;
+
+    //  whatever's left over is time no phase covers (the lineage, the console, checkpoints and so on)
+    for (int i = 0; i < NUM_PHASES; i++)
+    {
+        snprintf(line, sizeof(line), "# timing: %-9s %12.1f ms %6.1f%% %12lld runs\n", PHASE_NAMES[i], mRunTimes.mNanoseconds[i] / 1e6,
+            100 * mRunTimes.mNanoseconds[i] / 1e9 / mRunSeconds, (long long)mRunTimes.mCounts[i]);
+        mStatsText += line;
+    }
+
+    if (!mIsCounted)
+        return;
+
+    //  instructions per cycle, and misses per thousand instructions
+    for (int i = 0; i < NUM_PHASES; i++)
+    {
+        const int64_t * events = mRunTimes.mEvents[i];
+        double instructions = max((double)events[PERF_INSTRUCTIONS], 1.0);
+
+        snprintf(line, sizeof(line), "# counters: %-9s %14lld cycles %14lld instructions, ipc %.2f, %.2f cache misses and %.2f branch misses per 1000 instructions\n",
+            PHASE_NAMES[i], (long long)events[PERF_CYCLES], (long long)events[PERF_INSTRUCTIONS],
+            (events[PERF_CYCLES] > 0) ? events[PERF_INSTRUCTIONS] / (double)events[PERF_CYCLES] : 0.0,
+            1000 * events[PERF_CACHE_MISSES] / instructions, 1000 * events[PERF_BRANCH_MISSES] / instructions);
+        mStatsText += line;
+    }
+}
+
+int formatTimings(char * row, const double * columns)
+{
+    char * end = row;
+    for (int i = 0; i < NUM_TIMING_COLUMNS; i++)
+    {
+        *end++ = ',';
+        end = to_chars(end, row + TIMING_ROW_SIZE, columns[i], chars_format::general, 5).ptr;
+    }
+
+    return (int)(end - row);
+}
+
+void writeGenAverages(ostream & out, const genStats & stats)
+{
+    char row[GEN_AVERAGES_ROW_SIZE];
+    out.write(row, formatGenAverages(row, stats));
+}
+
+void world::setOutputNames(int simNumber)
+{
+    mFileSaveLoc = getPath();
+
+    stringstream statsName, genomeName, binaryName, traceName;
+    statsName << mFileSaveLoc << "sim" << simNumber << "_averages.csv";
+    genomeName << mFileSaveLoc << "sim" << simNumber << "_genomes.txt";
+    binaryName << mFileSaveLoc << "sim" << simNumber << "_averages.bin";
+    traceName << mFileSaveLoc << "sim" << simNumber << "_trace.bin";
+
+    //  the averages go to text, binary columns, or both
+    mStatsName = (mWorldSettings.mStatsFormat != STATS_BINARY) ? statsName.str() : "";
+    mGenomeName = genomeName.str();
+    mBinaryName = (mWorldSettings.mStatsFormat != STATS_TEXT) ? binaryName.str() : "";
+
+    //  islands breed in processes of their own, so only a single world is traced
+    mTraceName = (mWorldSettings.mTrace && mWorldSettings.mNumIslands <= 1) ? traceName.str() : "";
+}
+
+void world::createOutputFile(int simNumber, bool isResumed)
+{
+    setOutputNames(simNumber);
+    mSimNumber = simNumber;
+
+    if (mWorldSettings.mTiming && !IS_TIMING_BUILT)
+        cout << endl << "Phase timing needs a build made with 'make TIMING=1', so simulation " << simNumber << " isn't timed" << endl;
+    else if (mWorldSettings.mPerfCounters && !mWorldSettings.mTiming)
+        cout << endl << "Hardware counters are read by the phase timers, so they need timing as well" << endl;
+
+    //  the buffers have to be handed over before the files are opened
+    mStatsBuffer.resize(OUTPUT_BUFFER_SIZE);
+    mGenomeBuffer.resize(OUTPUT_BUFFER_SIZE);
+    fout.rdbuf()->pubsetbuf(&mStatsBuffer[0], mStatsBuffer.size());
+    gout.rdbuf()->pubsetbuf(&mGenomeBuffer[0], mGenomeBuffer.size());
+
+    //  a resumed simulation's files are cut back to where its checkpoint was saved, and carried on from there
+    ios::openmode mode = ios::out;
+    if (isResumed)
+    {
+        mode = ios::app;
+        if ((!mStatsName.empty() && truncate(mStatsName.c_str(), mOutputSizes[0]) != 0) || truncate(mGenomeName.c_str(), mOutputSizes[1]) != 0)
+            cout << endl << "Couldn't cut the output files in " << mFileSaveLoc << " back to the checkpoint" << endl;
+    }
+
+    if (!mStatsName.empty())
+        fout.open(mStatsName.c_str(), mode);
+    gout.open(mGenomeName.c_str(), mode);
+
+    if ((!mStatsName.empty() && !fout) || !gout)
+        cout << endl << "Couldn't open the output files in " << mFileSaveLoc << endl;
+
+    if (!mBinaryName.empty())
+    {
+        vector<string> columnNames(1, "generation");
+        columnNames.insert(columnNames.end(), GEN_AVERAGE_NAMES, GEN_AVERAGE_NAMES + NUM_GEN_AVERAGES);
+        columnNames.push_back("best_score");
+        if (mWorldSettings.mScoreDistribution)
+            columnNames.insert(columnNames.end(), DISTRIBUTION_NAMES, DISTRIBUTION_NAMES + NUM_DISTRIBUTION_COLUMNS);
+        if (mWorldSettings.mGeneDiversity)
+            columnNames.insert(columnNames.end(), DIVERSITY_NAMES, DIVERSITY_NAMES + NUM_DIVERSITY_COLUMNS);
+        if (isTimed())
+            columnNames.insert(columnNames.end(), TIMING_NAMES, TIMING_NAMES + NUM_TIMING_COLUMNS);
+
+        bool isOpen = isResumed ? mBinaryStats.reopen(mBinaryName, (int)columnNames.size(), mOutputSizes[2])
+            : mBinaryStats.open(mBinaryName, mWorldSettings, columnNames);
+        if (!isOpen)
+            cout << endl << "Couldn't open " << mBinaryName << endl;
+    }
+
+    if (!mTraceName.empty())
+    {
+        bool isGenerational = mWorldSettings.mSelectionMode != SELECT_TOURNAMENT;
+        bool isOpen = isResumed ? mTrace.reopen(mTraceName, mWorldSettings.mGenomeSize, mOutputSizes[3])
+            : mTrace.open(mTraceName, mWorldSettings.mGenomeSize, mWorldSettings.mPopulationSize, isGenerational);
+        if (!isOpen)
+            cout << endl << "Couldn't open " << mTraceName << endl;
+    }
+
+    //  everything written from here on goes through the background writer
+    mWriter.start();
+    mBinaryStats.setWriter(&mWriter);
+    mTrace.setWriter(&mWriter);
+
+    mHasOutput = true;
+}
+
+void world::outputSettings()
+{
+    //  the settings go in comment lines above the column names
+    fout << "# population " << mWorldSettings.mPopulationSize << ", generations " << mWorldSettings.mNumGenerations
+    << ", genome " << mWorldSettings.mGenomeSize << ", mutation rate " << mWorldSettings.mMutationRate
+    << ", selective pressure " << mWorldSettings.mSelectivePressureMagnitude << ", tournament size " << mWorldSettings.mTournamentSize
+    << ", selection mode " << mWorldSettings.mSelectionMode << ", islands " << mWorldSettings.mNumIslands << "\n";
+
+    for (int i = 0; i < NUM_GEN_AVERAGES; i++)
+        fout << (i > 0 ? "," : "") << GEN_AVERAGE_NAMES[i];
+    if (mWorldSettings.mScoreDistribution)
+        for (int i = 0; i < NUM_DISTRIBUTION_COLUMNS; i++)
+            fout << "," << DISTRIBUTION_NAMES[i];
+    if (mWorldSettings.mGeneDiversity)
+        for (int i = 0; i < NUM_DIVERSITY_COLUMNS; i++)
+            fout << "," << DIVERSITY_NAMES[i];
+    if (isTimed())
+        for (int i = 0; i < NUM_TIMING_COLUMNS; i++)
+            fout << "," << TIMING_NAMES[i];
+    fout << "\n";
+}
+
+world::~world()
+{
+    closeOutputFile();
+}
+
+void world::closeOutputFile()
+{
+    if (!mHasOutput)
+        return;
+
+    //  hand over what's left and wait for the writer to finish it
+    sendOutput(fout, mStatsText);
+    mBinaryStats.flush();
+    mTrace.flush();
+    mWriter.stop();
+    mBinaryStats.setWriter(NULL);
+    mTrace.setWriter(NULL);
+
+    if (mWriter.getNumStalls() > 0)
+        fout << "# output writer held up the simulation " << mWriter.getNumStalls() << " times\n";
+
+    mBinaryStats.close();
+    mTrace.close();
+    fout.flush();
+    gout.flush();
+    fout.close();
+    gout.close();
+
+    mHasOutput = false;
+}
+
+string getPath()
+{
+    //  output goes next to the executable, or the working directory if that can't be found
+    char path[4096];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
 
-    fout << bestPend << "," << secGearInterval << "," << minGearInterval << "," << hrGearInterval << "," << secGearHand << "," << minGearHand << ","
-	<< hrGearHand << "," << avgNotNullPieces << "," << avgSurvivalScore << "," << numDeadClocks << "," << numPendClocks << "," << numGearClocks << ","
-	<< num1HClocks << "," << num2HClocks << "," << num3HClocks;
+    if (length <= 0)
+        return "";
 
-	fout << endl;
+    string exePath(path, length);
+    return exePath.substr(0, exePath.rfind('/') + 1);
 }
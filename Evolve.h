@@ -4,13 +4,98 @@
 #define EVOLVE_H_INCLUDED
 
 #include "Clock.h"
+#include "Diversity.h"
 #include "Interface.h"
+#include "Lineage.h"
+#include "Reduce.h"
+#include "Selection.h"
+#include "StatsFile.h"
+#include "Store.h"
+#include "Timing.h"
+#include "Trace.h"
+#include "Writer.h"
 #include <fstream>
 //#include <direct.h>
 //#include <shlwapi.h>
 
 using namespace std;
 
+class island;
+
+//  size of the buffer behind each output file
+const int OUTPUT_BUFFER_SIZE = 1 << 20;
+
+//  the stats file is flushed every this many generations, so its progress can be followed while a run goes on
+const int STATS_FLUSH_GENS = 500;
+
+/*
+LAYOUT OF A CHECKPOINT (written by the machine that reads it, so numbers are in its own byte order):
+
+    header      "WECKPT01", uint32 version, uint32 size of varData, uint32 simulation number, uint32 1 if the simulation finished
+    settings    the varData the simulation runs with
+    progress    int32 generations run, int32 generations stalled, float64 best and mean records, the last genStats
+    output      int64 size of the stats, genome, binary stats and trace files (0 for one that isn't written)
+    population  uint32 clock count, then each clock as bioClock::saveState() writes it
+    lineage     the lineage tree as lineageTree::saveState() writes it, if lineages are followed
+    random      the MTRand state, MTRand::SAVE unsigned longs
+
+A checkpoint is written to a temporary file and renamed over the last one, so a crash leaves one whole checkpoint or the other.
+*/
+
+const char CHECKPOINT_MAGIC[8] = {'W', 'E', 'C', 'K', 'P', 'T', '0', '1'};
+const int CHECKPOINT_VERSION = 6;
+
+//  relative gain in the best or mean score that counts as an improvement when checking for convergence
+const double CONVERGE_TOLERANCE = 0.001;
+
+//  whether any of the criteria that can stop a run early are set
+bool hasStoppingCriteria(const varData & settings);
+
+//  names of the columns written by writeGenAverages(), in order
+const int NUM_GEN_AVERAGES = 15;
+const char * const GEN_AVERAGE_NAMES[NUM_GEN_AVERAGES] = {"pendulum_interval", "sec_gear_interval", "min_gear_interval", "hr_gear_interval",
+    "sec_hand", "min_hand", "hr_hand", "pieces", "survival_score", "dead_clocks", "pendulum_clocks", "gear_clocks",
+    "one_hand_clocks", "two_hand_clocks", "three_hand_clocks"};
+
+//  names of the columns the phase timings add to the stats files: milliseconds in each phase, then the whole generation's
+//  milliseconds and the clocks scored and children bred per second of it
+const int NUM_TIMING_COLUMNS = NUM_PHASES + 3;
+const char * const TIMING_NAMES[NUM_TIMING_COLUMNS] = {"sampling_ms", "scoring_ms", "sorting_ms", "crossover_ms", "recording_ms",
+    "averages_ms", "generation_ms", "evals_per_sec", "matings_per_sec"};
+
+//  holds the totals that a generation's averages are made from, so populations can be merged before dividing
+struct genStats
+{
+    //  constructor zeroes every total
+    genStats();
+
+    //  number of clocks that were counted
+    double mNumClocks;
+
+    //  totals over the living clocks (the survival score also counts dead clocks, which add nothing)
+    double mSurvivalScore;
+    double mSurvivalScoreSq;
+    double mBestPend;
+    double mGearInterval[3];
+    double mGearHand[3];
+    double mNotNullPieces;
+
+    //  number of clocks of each sort
+    double mNumDeadClocks;
+    double mNumPendClocks;
+    double mNumGearClocks;
+    double mNumHandClocks[3];
+
+    //  highest survival score in the population
+    double mBestScore;
+
+    //  adds the totals of another population
+    void merge(const genStats & other);
+};
+
+//  number of totals the world keeps in fixed point
+const int NUM_FIXED_TOTALS = 6;
+
 //  class to run the test instance
 class world
 {
@@ -19,18 +104,187 @@ private:
 	//	stores the population of clocks
     vector<bioClock> mPopulation;
 
+    //  the population when it's kept in a memory-mapped file instead (mPopulation is left empty), and the store its children
+    //  are bred into when the whole generation is replaced at once
+    clockStore mStore;
+    clockStore mChildStore;
+
+    //  these reach a clock wherever the population is kept
+    int getPopulationSize() {return mStore.isOpen() ? (int)mStore.size() : (int)mPopulation.size();};
+    double scoreClock(int index);
+    void setScored(int index, int isScored);
+    clockSummary getClockSummary(int index) {return mStore.isOpen() ? mStore.getSummary(index) : mPopulation[index].getSummary();};
+    bioClock & getClock(int index) {return mStore.isOpen() ? mStore.unpack(index) : mPopulation[index];};
+    void prefetchClock(int index);
+
+    //  makes a store the size of the population
+    bool openStore(clockStore & store);
+
     //  worldSettings contains the starting population size, mutation rate, and other global data
     varData mWorldSettings;
 
     //	mFileSaveLoc contains the location to which the file that the simulation details has been saved
     string mFileSaveLoc;
 
-    void outputGenAverages();
+    //  clock indexes that tournament contestants are drawn from, kept in sequence between tournaments
+    vector<int> mClockOrder;
+
+    //  scratch space for a tournament: the shuffle swaps made and the contestants' scores
+    vector<int> mSwapIndexes;
+    vector<double> mContestantScores;
+
+    //  draws a tournament and picks out the two best contestants (the parents) and the worst one (the loser)
+    void runTournament(MTRand & randGen, int & parent1, int & parent2, int & loser);
+
+    //  alias table of parent chances, and the scores and weights it's built from, rebuilt once per generation
+    aliasTable mParentTable;
+    vector<double> mScores;
+    vector<double> mWeights;
+
+    //  replaces the whole population with children of parents drawn from the alias table
+    void breedGeneration(MTRand & randGen);
+
+    //  best and mean scores to beat, and how many generations have gone by without beating either
+    double mBestRecord;
+    double mMeanRecord;
+    int mStalledGens;
+
+    //  the island this world runs on when the simulation is split into processes (NULL otherwise)
+    island * mIsland;
+
+    //  totals over every clock as it was last scored, kept up to date as clocks are scored and replaced, and the clock
+    //  with the best score (which is looked for again when it's needed, if that clock has lost its score since)
+    genStats mRunningStats;
+    int mBestClock;
+    bool mIsBestStale;
+
+    //  the totals that aren't whole numbers (the score, its square, and the pendulum and gear intervals) are kept in
+    //  fixed point, so taking a clock out exactly undoes putting it in however long the run goes, and whether a value too
+    //  big for fixed point has been left out of them since they were last added up from scratch
+    __int128 mFixedTotals[NUM_FIXED_TOTALS];
+    bool mIsFixedLost;
+
+    //  adds or takes away a value from one of the fixed point totals
+    void addFixed(int total, double value, int sign);
+
+    //  adds or takes away what a clock counts for in the running totals
+    void countClock(const clockSummary & summary, int sign);
+
+    //  takes a clock's last summary out of the running totals, and puts its new one in
+    void updateStats(int index, const clockSummary & oldSummary);
+
+    //  empties the running totals
+    void clearStats();
+
+    //  totals up every clock's last summary from scratch, without scoring any of them
+    void resetStats();
+
+    //  scores a clock that's just been born or arrived, so the statistics count it, without changing how the run goes
+    double scoreNewborn(int index);
+
+    //  scores every clock that hasn't been yet as a newborn
+    void scoreNewborns();
+
+    //  works out how the scores last given to the clocks are spread out
+    scoreDistribution calcDistribution();
+
+    //  fingerprints of the clocks' genomes, and how diverse they were at the end of the last generation
+    fingerprintSet mFingerprints;
+    geneDiversity mDiversity;
+
+    //  whether the stats written are of clocks this world doesn't have, so it can't work out their distribution
+    bool mIsPopulationUnseen;
+
+    //  packs every clock's fingerprint and works out the population's diversity, drawing pairs by the generation's number
+    geneDiversity calcDiversity(int generation);
+
+    //  whether the phases of each generation are timed, which needs a build with the timers compiled in
+    bool isTimed() {return IS_TIMING_BUILT && mWorldSettings.mTiming && mIsland == NULL;};
+
+    //  the thread's accumulators and the time when the last stats row was written, and the totals over the run so far
+    phaseTimes mRowTimes;
+    chrono::steady_clock::time_point mRowTime;
+    phaseTimes mRunTimes;
+    double mRunSeconds;
+
+    //  whether the hardware counters are being read along with the times
+    bool mIsCounted;
+
+    //  fills the timing columns (in the order of TIMING_NAMES) with what was spent since the last row
+    void takeTimingColumns(double * columns);
+
+    //  adds the time spent in each phase over the whole run to the stats file, as comment lines
+    void writeTimingSummary();
+
+    //  totals of the last generation run, and how many generations that was
+    genStats mLastStats;
+    int mGensRun;
+
+    //  large buffers behind the output files, so rows are only handed to the system in big blocks
+    vector<char> mStatsBuffer;
+    vector<char> mGenomeBuffer;
+
+    //  the binary columnar stats file, when it's asked for
+    statsWriter mBinaryStats;
+
+    //  the offspring trace, when it's asked for, and room for the genes of a child and its first parent
+    traceWriter mTrace;
+    vector<pieceGene> mTraceParent;
+    vector<pieceGene> mTraceChild;
+
+    //  ancestry of the population, when it's followed
+    lineageTree mLineage;
+
+    //  writes the line of descent of the best clock to its own file
+    void writeLineage();
+
+    //  records a child born into 'slot' in the trace, with the score it was given as it was born
+    void traceChild(int parent1, int parent2, int slot, bioClock & child, double score);
+
+    //  copies a clock's genes out, wherever the population is kept
+    void getGenome(int index, pieceGene * genome);
+
+    //  if the output files have been opened
+    bool mHasOutput;
+
+    //  background thread that all output is handed to once the files are open
+    asyncWriter mWriter;
+
+    //  text gathered for the console, genome file and stats file before it's handed over
+    string mConsoleText;
+    string mGenomeText;
+    string mStatsText;
+
+    //  hands text to the background writer (or writes it directly when that isn't running), leaving 'text' empty
+    void sendOutput(ostream & target, string & text);
+
+    //  the simulation's number (0 until its output files are made or its checkpoint is loaded), and whether it has ended
+    int mSimNumber;
+    bool mIsFinished;
+
+    //  paths of the output files
+    string mStatsName;
+    string mGenomeName;
+    string mBinaryName;
+    string mTraceName;
+
+    //  sizes of the stats, genome, binary stats and trace files when the loaded checkpoint was saved, which resuming cuts them back to
+    long mOutputSizes[4];
+
+    //  works out the output file paths of simulation 'simNumber' (empty for a file that isn't written)
+    void setOutputNames(int simNumber);
+
+    //  where the simulation's checkpoint is kept
+    string getCheckpointName(int simNumber);
+
+    //  writes everything needed to carry on from the current generation
+    void saveCheckpoint();
 
 public:
 
     //  the constructor is built based on the user entered restrictions
-    world (varData worldSettings);
+    world (varData worldSettings, island * worldIsland = NULL);
+    ~world();
 
     //  create the first generation of clocks randomly
     void initClocks();
@@ -38,20 +292,93 @@ public:
     //  this is the algorithm used to 'mate' clocks
     void mateClocks();
 
-    //  records generation data to file
-    void recordGeneration();
+    //  records a clock's genome to file, and to the console as well if it's shown
+    void recordGeneration(int clockIndex, bool isShown);
+
+    //  the generation's statistics, from the running totals
+    genStats calcGenStats();
+
+    //  writes a generation's averages to the stats files
+    void outputGenAverages(genStats stats, int generation);
+
+    //  checks the stopping criteria after a generation, given its totals and gene diversity, returning why the run should
+    //  stop (empty to keep going)
+    string checkConvergence(const genStats & stats, const geneDiversity & diversity);
+
+    //  writes why the run stopped after generation 'gensRun' to the console and the stats file
+    void outputStop(int gensRun, string reason);
+
+    //  writes a comment line to the stats file, between the rows already written and the next
+    void outputComment(string comment);
+
+    //  writes the columns worked out from the clocks themselves (the score distribution and the gene diversity) as nan from
+    //  now on, for a world that never sees the clocks it writes the stats of
+    void setPopulationUnseen();
+
+    //  a checksum of every clock's genes and last score, so two runs can be checked for having done the same work
+    uint64_t calcChecksum();
+
+    //  adds up every clock's last summary again from scratch and compares it with the running totals, returning what
+    //  doesn't match (nothing if it all does)
+    string checkStats();
+
+    //  results of the last generation that was run
+    genStats getLastStats() {return mLastStats;};
+    int getGensRun() {return mGensRun;};
 
     //  the file that the generation data will be output to
     ofstream fout;
     ofstream gout;
 
-    //  create and open file to output to
-    void createOutputFile();
+    //  create and open the files to output simulation 'simNumber' to, or reopen them to carry on after a checkpoint
+    void createOutputFile(int simNumber, bool isResumed = false);
+
+    //  loads the population and progress of simulation 'simNumber' from its checkpoint, returning false if it has none
+    bool loadCheckpoint(int simNumber);
+
+    //  if the loaded checkpoint was saved after the simulation ended
+    bool isFinished() {return mIsFinished;};
 
     //  print simulation setting to file
     void outputSettings();
+
+    //  writes out anything still buffered and closes the files
+    void closeOutputFile();
 };
 
+//  longest row formatGenAverages() can write
+const int GEN_AVERAGES_ROW_SIZE = NUM_GEN_AVERAGES * 32;
+
+//  divides a generation's totals out into the averages, in the order of GEN_AVERAGE_NAMES
+void calcGenAverages(const genStats & stats, double * averages);
+
+//  formats a generation's averages as one comma-separated row (without a line end) and returns its length
+int formatGenAverages(char * row, const genStats & stats);
+
+//  longest part of a row formatDistribution() can write
+const int DISTRIBUTION_ROW_SIZE = NUM_DISTRIBUTION_COLUMNS * 32;
+
+//  puts a score distribution in the order of DISTRIBUTION_NAMES
+void getDistributionColumns(const scoreDistribution & distribution, double * columns);
+
+//  formats a score distribution as the end of a row, each column led by a comma, and returns its length
+int formatDistribution(char * row, const scoreDistribution & distribution);
+
+//  longest part of a row formatDiversity() can write
+const int DIVERSITY_ROW_SIZE = NUM_DIVERSITY_COLUMNS * 32;
+
+//  formats a population's diversity as the end of a row, each column led by a comma, and returns its length
+int formatDiversity(char * row, const geneDiversity & diversity);
+
+//  longest part of a row formatTimings() can write
+const int TIMING_ROW_SIZE = NUM_TIMING_COLUMNS * 32;
+
+//  formats the timing columns as the end of a row, each column led by a comma, and returns its length
+int formatTimings(char * row, const double * columns);
+
+//  writes a generation's averages as one comma-separated row (without ending the line)
+void writeGenAverages(ostream & out, const genStats & stats);
+
 //  the details for this function were found at http://www.hardforum.com/showthread.php?t=973922 from Shadow2531 and gets the path of the executable file
 string getPath();
 
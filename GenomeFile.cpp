@@ -0,0 +1,243 @@
+//  this file defines the genome files
+#include "GenomeFile.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdint.h>
+
+using namespace std;
+
+//  the letters of the text grids, by piece type
+const char PIECE_LETTERS[] = {' ', 'E', 'M', 'G', 'H', 'P'};
+
+genomeWriter::genomeWriter()
+{
+    mNumCells = 0;
+}
+
+bool genomeWriter::open(string path, int genomeSize)
+{
+    mFile.open(path.c_str(), ios::binary | ios::trunc);
+    if (!mFile)
+        return false;
+
+    mNumCells = genomeSize * genomeSize;
+    mValues.resize(mNumCells);
+    mTypes.resize(mNumCells);
+
+    uint32_t header[2] = {(uint32_t)GENOME_VERSION, (uint32_t)genomeSize};
+    mFile.write(GENOME_MAGIC, sizeof(GENOME_MAGIC));
+    mFile.write((const char *)header, sizeof(header));
+
+    return (bool)mFile;
+}
+
+void genomeWriter::add(const pieceGene * genome)
+{
+    for (int i = 0; i < mNumCells; i++)
+    {
+        mTypes[i] = (unsigned char)genome[i].mPieceType;
+        mValues[i] = (genome[i].mPieceType == PTYPE_GEAR) ? genome[i].mNumTeeth
+            : (genome[i].mPieceType == PTYPE_PENDULUM) ? genome[i].mPendulumLength : 0;
+    }
+
+    mFile.write((const char *)&mValues[0], mNumCells * sizeof(double));
+    mFile.write((const char *)&mTypes[0], mNumCells);
+}
+
+bool genomeWriter::close()
+{
+    if (!mFile.is_open())
+        return true;
+
+    mFile.close();
+    return !mFile.fail();
+}
+
+genomeReader::genomeReader()
+{
+    mIsBinary = false;
+    mGenomeSize = 0;
+    mNumCells = 0;
+    mTextTeeth = 0;
+    mTextLength = 0;
+    mLineNumber = 0;
+    mHasPendingRow = false;
+}
+
+bool genomeReader::open(string path, int genomeSize, int textTeeth, double textLength)
+{
+    mFile.open(path.c_str(), ios::binary);
+    if (!mFile)
+    {
+        mError = "can't open the file";
+        return false;
+    }
+
+    char magic[sizeof(GENOME_MAGIC)];
+    mFile.read(magic, sizeof(magic));
+    mIsBinary = (mFile.gcount() == sizeof(magic) && memcmp(magic, GENOME_MAGIC, sizeof(magic)) == 0);
+
+    if (mIsBinary)
+    {
+        uint32_t header[2];
+        if (!mFile.read((char *)header, sizeof(header)) || header[0] != (uint32_t)GENOME_VERSION || header[1] == 0)
+        {
+            mError = "the header isn't one this version can read";
+            return false;
+        }
+        mGenomeSize = header[1];
+    }
+    else
+    {
+        //  text is read from the start again
+        mFile.clear();
+        mFile.seekg(0);
+
+        mTextTeeth = textTeeth;
+        mTextLength = textLength;
+        mGenomeSize = genomeSize;
+
+        if (mGenomeSize <= 0)
+        {
+            if (!readRow(mPendingRow) || mPendingRow.empty())
+            {
+                if (mError.empty())
+                    mError = "there's no genome to find the size of";
+                return false;
+            }
+            mHasPendingRow = true;
+            mGenomeSize = mPendingRow.size();
+        }
+    }
+
+    mNumCells = mGenomeSize * mGenomeSize;
+    return true;
+}
+
+bool genomeReader::readRow(string & row)
+{
+    if (mHasPendingRow)
+    {
+        row = mPendingRow;
+        mHasPendingRow = false;
+        return true;
+    }
+
+    while (getline(mFile, row))
+    {
+        mLineNumber++;
+
+        if (!row.empty() && row[row.size() - 1] == '\r')
+            row.erase(row.size() - 1);
+
+        if (row.empty() || row[0] == '#' || row.compare(0, 6, "clock ") == 0)
+            continue;
+
+        return true;
+    }
+
+    return false;
+}
+
+bool genomeReader::readBinary(pieceGene * genome)
+{
+    mRecord.resize(mNumCells * (sizeof(double) + 1));
+    mFile.read(&mRecord[0], mRecord.size());
+
+    if (mFile.gcount() == 0)
+        return false;
+    if (mFile.gcount() != (streamsize)mRecord.size())
+    {
+        mError = "the last genome is cut short";
+        return false;
+    }
+
+    const char * values = mRecord.data();
+    const unsigned char * types = (const unsigned char *)values + mNumCells * sizeof(double);
+
+    for (int i = 0; i < mNumCells; i++)
+    {
+        double value;
+        memcpy(&value, values + i * sizeof(double), sizeof(double));
+
+        genome[i] = NULL_GENE;
+        genome[i].mPieceType = types[i];
+        if (types[i] == PTYPE_GEAR)
+            genome[i].mNumTeeth = (int)value;
+        else if (types[i] == PTYPE_PENDULUM)
+            genome[i].mPendulumLength = value;
+        else if (types[i] > PTYPE_AMT)
+        {
+            mError = "a piece has a type that doesn't exist";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool genomeReader::readText(pieceGene * genome)
+{
+    string row;
+
+    for (int x = 0; x < mGenomeSize; x++)
+    {
+        if (!readRow(row))
+        {
+            if (x > 0)
+                mError = "the last genome is cut short";
+            return false;
+        }
+
+        stringstream error;
+        if ((signed int)row.size() > mGenomeSize)
+        {
+            error << "line " << mLineNumber << " is longer than the genome size (" << mGenomeSize << ")";
+            mError = error.str();
+            return false;
+        }
+
+        //  trimmed rows end in empty pieces
+        row.resize(mGenomeSize, ' ');
+
+        for (int y = 0; y < mGenomeSize; y++)
+        {
+            const char * letter = (const char *)memchr(PIECE_LETTERS, row[y], sizeof(PIECE_LETTERS));
+            if (letter == NULL)
+            {
+                error << "line " << mLineNumber << " has '" << row[y] << "', which isn't a piece";
+                mError = error.str();
+                return false;
+            }
+
+            pieceGene & gene = genome[x * mGenomeSize + y];
+            gene = NULL_GENE;
+            gene.mPieceType = letter - PIECE_LETTERS;
+            if (gene.mPieceType == PTYPE_GEAR)
+                gene.mNumTeeth = mTextTeeth;
+            else if (gene.mPieceType == PTYPE_PENDULUM)
+                gene.mPendulumLength = mTextLength;
+        }
+    }
+
+    return true;
+}
+
+long genomeReader::read(vector<pieceGene> & genomes, long maxGenomes)
+{
+    //  the vector grows a genome at a time, and keeps its space from one read to the next
+    genomes.clear();
+
+    long numRead = 0;
+    while (numRead < maxGenomes && mError.empty())
+    {
+        genomes.resize((numRead + 1) * mNumCells);
+        if (!(mIsBinary ? readBinary(&genomes[numRead * mNumCells]) : readText(&genomes[numRead * mNumCells])))
+            break;
+        numRead++;
+    }
+
+    genomes.resize(numRead * mNumCells);
+    return numRead;
+}
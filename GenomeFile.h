@@ -0,0 +1,111 @@
+//  this file contains the genome files that genomes are scored from: the binary kind, and the text grids of a genome file
+
+#ifndef GENOMEFILE_H_INCLUDED
+#define GENOMEFILE_H_INCLUDED
+
+#include "Clock.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+LAYOUT OF A BINARY GENOME FILE (all numbers little-endian):
+
+    header    "WEGENOM1", uint32 version, uint32 genome size
+    genomes   one after another, each genomeSize^2 float64 values then genomeSize^2 uint8 piece types, row by row
+
+A value is the number of teeth of a gear, the length of a pendulum, and 0 for any other piece, as in the population store.
+Every genome is the same size, so a reader can find the nth one without reading those before it.
+
+A TEXT GENOME FILE is what simN_genomes.txt and tracereplay write: each genome is genomeSize rows of one letter per piece
+(' ', E, M, G, H or P), one row per line. Empty lines, and lines starting with '#' or "clock ", are skipped. The genome
+size is the length of the first row unless it's given. Rows shorter than that are padded with empty pieces, since their
+trailing spaces may have been trimmed. The letters don't say how many teeth a gear has or how long a pendulum is, so
+every gear and pendulum read from text gets the same values, given to the reader.
+*/
+
+//  fixed parts of the binary file
+const char GENOME_MAGIC[8] = {'W', 'E', 'G', 'E', 'N', 'O', 'M', '1'};
+const int GENOME_VERSION = 1;
+
+//  writes a binary genome file
+class genomeWriter
+{
+private:
+
+    ofstream mFile;
+    int mNumCells;
+
+    //  one genome's packed values and types
+    vector<double> mValues;
+    vector<unsigned char> mTypes;
+
+public:
+
+    genomeWriter();
+
+    //  creates the file and writes the header; returns false if it can't be opened
+    bool open(string path, int genomeSize);
+
+    //  appends a genome (genomeSize * genomeSize genes, row by row)
+    void add(const pieceGene * genome);
+
+    //  returns false if anything couldn't be written
+    bool close();
+};
+
+//  reads genomes from a binary or text genome file, whichever it finds
+class genomeReader
+{
+private:
+
+    ifstream mFile;
+    bool mIsBinary;
+    int mGenomeSize;
+    int mNumCells;
+
+    //  what gears and pendulums read from text get
+    int mTextTeeth;
+    double mTextLength;
+
+    //  the text line a genome is being read from, for errors, and the first row, read to find the genome size
+    long mLineNumber;
+    string mPendingRow;
+    bool mHasPendingRow;
+
+    //  one binary genome as it's read
+    string mRecord;
+
+    string mError;
+
+    //  reads the next row of a text grid, skipping what isn't one
+    bool readRow(string & row);
+
+    //  read one genome; return false at the end of the file, or on an error
+    bool readBinary(pieceGene * genome);
+    bool readText(pieceGene * genome);
+
+    genomeReader (const genomeReader &);
+    genomeReader & operator= (const genomeReader &);
+
+public:
+
+    genomeReader();
+
+    //  opens a file, telling binary from text by its first bytes; a text file's genome size is found from its first row
+    //  when 'genomeSize' is 0, and every gear and pendulum in it gets 'textTeeth' teeth and a 'textLength' length
+    bool open(string path, int genomeSize, int textTeeth, double textLength);
+
+    bool isBinary() {return mIsBinary;};
+    int getGenomeSize() {return mGenomeSize;};
+
+    //  reads up to 'maxGenomes' genomes into 'genomes', returning how many were read (0 at the end of the file, or on an error)
+    long read(vector<pieceGene> & genomes, long maxGenomes);
+
+    //  what went wrong, if a read stopped at something it couldn't read
+    string getError() {return mError;};
+};
+
+#endif // GENOMEFILE_H_INCLUDED
@@ -1,6 +1,8 @@
 //  this file defines all interaction/output functions
 #include "Interface.h"
 
+#include <cmath>
+
 // 	convert a string to an integer
 int stringTOint (string text)
 {
@@ -30,6 +32,124 @@ varData::varData ()
     mGenomeSize = 10;
     mMutationRate = 1;
     mSelectivePressureMagnitude = 10;
+    mTournamentSize = 3;
+    mSelectionMode = 0;
+    mRankPressure = 1.5;
+    mStallWindow = 0;
+    mTargetScore = 0;
+    mMinDiversity = 0;
+    mMinGeneDiversity = 0;
+    mStatsFormat = STATS_TEXT;
+    mShowInterval = 1;
+    mNumIslands = 1;
+    mMigrationInterval = 10;
+    mNumMigrants = 1;
+    mPopulationStore = 0;
+    mTiming = 0;
+    mPerfCounters = 0;
+    mScoreDistribution = 0;
+    mGeneDiversity = 0;
+    mTrace = 0;
+    mLineage = 0;
+    mSeed = 0;
+    mCheckpointInterval = 0;
+    mResume = 0;
+}
+
+const settingRange SETTING_RANGES[] =
+{
+    {"sims", 1, 10000, true, &varData::mSimTimes, NULL},
+    {"pop", 3, 1000000000, true, NULL, &varData::mPopulationSize},
+    {"gens", 1, 1000000000, true, NULL, &varData::mNumGenerations},
+    {"mrate", 0, 100, false, NULL, &varData::mMutationRate},
+    {"genome", 1, 50, true, &varData::mGenomeSize, NULL},
+    {"selmag", 1, 10000000, true, &varData::mSelectivePressureMagnitude, NULL},
+    {"tsize", 3, 10000, true, &varData::mTournamentSize, NULL},
+    {"selmode", 0, 2, true, &varData::mSelectionMode, NULL},
+    {"rankp", 1, 2, false, NULL, &varData::mRankPressure},
+    {"window", 0, 10000, true, &varData::mStallWindow, NULL},
+    {"target", 0, 1000000000, false, NULL, &varData::mTargetScore},
+    {"mindiv", 0, 10, false, NULL, &varData::mMinDiversity},
+    {"minhamming", 0, 1, false, NULL, &varData::mMinGeneDiversity},
+    {"binary", 0, 2, true, &varData::mStatsFormat, NULL},
+    {"show", 0, 10000, true, &varData::mShowInterval, NULL},
+    {"islands", 1, 64, true, &varData::mNumIslands, NULL},
+    {"migint", 1, 10000, true, &varData::mMigrationInterval, NULL},
+    {"migrants", 0, 100, true, &varData::mNumMigrants, NULL},
+    {"store", 0, 2, true, &varData::mPopulationStore, NULL},
+    {"timing", 0, 1, true, &varData::mTiming, NULL},
+    {"perf", 0, 1, true, &varData::mPerfCounters, NULL},
+    {"dist", 0, 1, true, &varData::mScoreDistribution, NULL},
+    {"genediv", 0, 1, true, &varData::mGeneDiversity, NULL},
+    {"trace", 0, 1, true, &varData::mTrace, NULL},
+    {"lineage", 0, 1, true, &varData::mLineage, NULL},
+    {"seed", 0, 4294967295.0, true, NULL, &varData::mSeed},
+    {"ckpt", 0, 10000, true, &varData::mCheckpointInterval, NULL},
+    {"resume", 0, 1, true, &varData::mResume, NULL}
+};
+
+const int NUM_SETTINGS = sizeof(SETTING_RANGES) / sizeof(SETTING_RANGES[0]);
+
+string readSettingValue (const settingRange & range, string text, double & value)
+{
+    string name = range.mName;
+
+    //  the whole of the text has to be the number, unlike the console, which takes whatever digits it can find
+    char * end = NULL;
+    value = strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !isfinite(value))
+        return "'" + text + "' isn't a number for " + name;
+
+    if (range.mIsWhole && value != floor(value))
+        return name + " has to be a whole number, not " + text;
+
+    if (value < range.mMin || value > range.mMax)
+    {
+        stringstream error;
+        error << name << " has to be from " << (long long)range.mMin << " to " << (long long)range.mMax << ", not " << text;
+        return error.str();
+    }
+
+    return "";
+}
+
+string applySetting (varData & settings, string name, string text)
+{
+    const settingRange * range = NULL;
+    for (int i = 0; i < NUM_SETTINGS && range == NULL; i++)
+        if (name == SETTING_RANGES[i].mName)
+            range = &SETTING_RANGES[i];
+
+    if (range == NULL)
+        return "unknown setting '" + name + "'";
+
+    double value;
+    string error = readSettingValue(*range, text, value);
+    if (!error.empty())
+        return error;
+
+    if (range->mIntField != NULL)
+        settings.*(range->mIntField) = (int)value;
+    else
+        settings.*(range->mDoubleField) = value;
+
+    return "";
+}
+
+string applySettings (varData & settings, const vector<string> & words)
+{
+    for (int i = 0; i < (signed int)words.size(); i++)
+    {
+        size_t split = words[i].find('=');
+        if (split == string::npos)
+            return "'" + words[i] + "' isn't a name=value setting";
+
+        string error = applySetting(settings, words[i].substr(0, split), words[i].substr(split + 1));
+        if (!error.empty())
+            return error;
+    }
+
+    return "";
 }
 
 //  outputs help info for commands
@@ -93,15 +213,59 @@ varData runCLI ()
     string simTimes = "sims";
     string simTimeDetails = " [1 - 10000]";
     string population = "pop";
-    string populationDetails = " [3 - 10000]";
+    string populationDetails = " [3 - 1000000000]";
     string numGenerations = "gens";
-    string numGenDetails = " [1 - 10000]";
+    string numGenDetails = " [1 - 1000000000]";
     string mutationRate = "mrate";
     string mutationRateDetails = " [0 - 100]";
     string genomeSize = "genome";
     string genomeSizeDetails = " [1 - 50]";
     string selectivePressure = "selmag";
     string selectivePressureDetails = " [1 - 10000000]";
+    string tournamentSize = "tsize";
+    string tournamentSizeDetails = " [3 - 10000]";
+    string selectionMode = "selmode";
+    string selectionModeDetails = " [0 - 2]";
+    string rankPressure = "rankp";
+    string rankPressureDetails = " [1 - 2]";
+    string stallWindow = "window";
+    string stallWindowDetails = " [0 - 10000]";
+    string targetScore = "target";
+    string targetScoreDetails = " [0 - 1000000000]";
+    string minDiversity = "mindiv";
+    string minDiversityDetails = " [0 - 10]";
+    string minGeneDiversity = "minhamming";
+    string minGeneDiversityDetails = " [0 - 1]";
+    string statsFormat = "binary";
+    string statsFormatDetails = " [0 - 2]";
+    string showInterval = "show";
+    string showIntervalDetails = " [0 - 10000]";
+    string numIslands = "islands";
+    string numIslandsDetails = " [1 - 64]";
+    string migrationInterval = "migint";
+    string migrationIntervalDetails = " [1 - 10000]";
+    string numMigrants = "migrants";
+    string numMigrantsDetails = " [0 - 100]";
+    string populationStore = "store";
+    string populationStoreDetails = " [0 - 2]";
+    string timing = "timing";
+    string timingDetails = " [0 - 1]";
+    string perfCounters = "perf";
+    string perfCountersDetails = " [0 - 1]";
+    string scoreDistribution = "dist";
+    string scoreDistributionDetails = " [0 - 1]";
+    string geneDiversity = "genediv";
+    string geneDiversityDetails = " [0 - 1]";
+    string trace = "trace";
+    string traceDetails = " [0 - 1]";
+    string lineage = "lineage";
+    string lineageDetails = " [0 - 1]";
+    string seed = "seed";
+    string seedDetails = " [0 - 4294967295]";
+    string checkpointInterval = "ckpt";
+    string checkpointIntervalDetails = " [0 - 10000]";
+    string resume = "resume";
+    string resumeDetails = " [0 - 1]";
     string help = "help";
     string run = "run";
     string quit = "quit";
@@ -126,6 +290,28 @@ varData runCLI ()
             writeSettingHelp (genomeSize, genomeSizeDetails, "Sets the size of the genome matrix.");
             writeSettingHelp (mutationRate, mutationRateDetails, "Sets the percent rate of mutation.");
             writeSettingHelp (selectivePressure, selectivePressureDetails, "Sets the magnitude of selective pressure.");
+            writeSettingHelp (tournamentSize, tournamentSizeDetails, "Sets the number of clocks per tournament.");
+            writeSettingHelp (selectionMode, selectionModeDetails, "Sets selection: tournament, roulette, rank.");
+            writeSettingHelp (rankPressure, rankPressureDetails, "Sets the pressure of rank selection.");
+            writeSettingHelp (stallWindow, stallWindowDetails, "Stops after this many gens without gain.");
+            writeSettingHelp (targetScore, targetScoreDetails, "Stops once the best score reaches this.");
+            writeSettingHelp (minDiversity, minDiversityDetails, "Stops once score diversity drops below.");
+            writeSettingHelp (minGeneDiversity, minGeneDiversityDetails, "Stops once gene diversity drops below.");
+            writeSettingHelp (statsFormat, statsFormatDetails, "Sets stats output: text, binary, both.");
+            writeSettingHelp (showInterval, showIntervalDetails, "Shows every Nth generation (0 for none).");
+            writeSettingHelp (numIslands, numIslandsDetails, "Sets the number of island processes.");
+            writeSettingHelp (migrationInterval, migrationIntervalDetails, "Sets the generations between migrations.");
+            writeSettingHelp (numMigrants, numMigrantsDetails, "Sets the clocks sent per migration.");
+            writeSettingHelp (populationStore, populationStoreDetails, "Keeps the population in a mapped file (2: shared tiles).");
+            writeSettingHelp (timing, timingDetails, "Adds phase timings to the stats (TIMING=1 builds).");
+            writeSettingHelp (perfCounters, perfCountersDetails, "Adds hardware counters to the phase timings.");
+            writeSettingHelp (scoreDistribution, scoreDistributionDetails, "Adds score quantiles and a histogram to the stats.");
+            writeSettingHelp (geneDiversity, geneDiversityDetails, "Adds the gene diversity to the stats.");
+            writeSettingHelp (trace, traceDetails, "Writes every child born to a trace file.");
+            writeSettingHelp (lineage, lineageDetails, "Writes the best clock's line of descent.");
+            writeSettingHelp (seed, seedDetails, "Seeds the random numbers (0 for a new seed).");
+            writeSettingHelp (checkpointInterval, checkpointIntervalDetails, "Saves a checkpoint every N gens (0 for none).");
+            writeSettingHelp (resume, resumeDetails, "Carries on from saved checkpoints.");
             cout << endl << "run                       Executes simulation using current settings." << endl;
             cout << "quit                      Quit simulation." << endl << endl;
         }
@@ -152,6 +338,72 @@ varData runCLI ()
         userSettings.mSelectivePressureMagnitude = stringTOint(getSetting (settingEntry, selectivePressure, userSettings.mSelectivePressureMagnitude));
         cout << "The selective pressure magnitude is set to " << userSettings.mSelectivePressureMagnitude << endl;
 
+        userSettings.mTournamentSize = stringTOint(getSetting (settingEntry, tournamentSize, userSettings.mTournamentSize));
+        cout << "The tournament size is set to " << userSettings.mTournamentSize << endl;
+
+        userSettings.mSelectionMode = stringTOint(getSetting (settingEntry, selectionMode, userSettings.mSelectionMode));
+        cout << "The selection mode is set to " << userSettings.mSelectionMode << endl;
+
+        userSettings.mRankPressure = stringTOdouble(getSetting (settingEntry, rankPressure, userSettings.mRankPressure));
+        cout << "The rank selection pressure is set to " << userSettings.mRankPressure << endl;
+
+        userSettings.mStallWindow = stringTOint(getSetting (settingEntry, stallWindow, userSettings.mStallWindow));
+        cout << "The stall window is set to " << userSettings.mStallWindow << endl;
+
+        userSettings.mTargetScore = stringTOdouble(getSetting (settingEntry, targetScore, userSettings.mTargetScore));
+        cout << "The target score is set to " << userSettings.mTargetScore << endl;
+
+        userSettings.mMinDiversity = stringTOdouble(getSetting (settingEntry, minDiversity, userSettings.mMinDiversity));
+        cout << "The minimum score diversity is set to " << userSettings.mMinDiversity << endl;
+
+        userSettings.mMinGeneDiversity = stringTOdouble(getSetting (settingEntry, minGeneDiversity, userSettings.mMinGeneDiversity));
+        cout << "The minimum gene diversity is set to " << userSettings.mMinGeneDiversity << endl;
+
+        userSettings.mStatsFormat = stringTOint(getSetting (settingEntry, statsFormat, userSettings.mStatsFormat));
+        cout << "The stats format is set to " << userSettings.mStatsFormat << endl;
+
+        userSettings.mShowInterval = stringTOint(getSetting (settingEntry, showInterval, userSettings.mShowInterval));
+        cout << "The console shows every " << userSettings.mShowInterval << " generations" << endl;
+
+        userSettings.mNumIslands = stringTOint(getSetting (settingEntry, numIslands, userSettings.mNumIslands));
+        cout << "The number of islands is set to " << userSettings.mNumIslands << endl;
+
+        userSettings.mMigrationInterval = stringTOint(getSetting (settingEntry, migrationInterval, userSettings.mMigrationInterval));
+        cout << "The migration interval is set to " << userSettings.mMigrationInterval << endl;
+
+        userSettings.mNumMigrants = stringTOint(getSetting (settingEntry, numMigrants, userSettings.mNumMigrants));
+        cout << "The number of migrants is set to " << userSettings.mNumMigrants << endl;
+
+        userSettings.mPopulationStore = stringTOint(getSetting (settingEntry, populationStore, userSettings.mPopulationStore));
+        cout << "The memory-mapped population store is set to " << userSettings.mPopulationStore << endl;
+
+        userSettings.mTiming = stringTOint(getSetting (settingEntry, timing, userSettings.mTiming));
+        cout << "Phase timing is set to " << userSettings.mTiming << endl;
+
+        userSettings.mPerfCounters = stringTOint(getSetting (settingEntry, perfCounters, userSettings.mPerfCounters));
+        cout << "Hardware counters are set to " << userSettings.mPerfCounters << endl;
+
+        userSettings.mScoreDistribution = stringTOint(getSetting (settingEntry, scoreDistribution, userSettings.mScoreDistribution));
+        cout << "The score distribution is set to " << userSettings.mScoreDistribution << endl;
+
+        userSettings.mGeneDiversity = stringTOint(getSetting (settingEntry, geneDiversity, userSettings.mGeneDiversity));
+        cout << "The gene diversity is set to " << userSettings.mGeneDiversity << endl;
+
+        userSettings.mTrace = stringTOint(getSetting (settingEntry, trace, userSettings.mTrace));
+        cout << "The offspring trace is set to " << userSettings.mTrace << endl;
+
+        userSettings.mLineage = stringTOint(getSetting (settingEntry, lineage, userSettings.mLineage));
+        cout << "Lineage tracking is set to " << userSettings.mLineage << endl;
+
+        userSettings.mSeed = stringTOdouble(getSetting (settingEntry, seed, userSettings.mSeed));
+        cout << "The random seed is set to " << userSettings.mSeed << endl;
+
+        userSettings.mCheckpointInterval = stringTOint(getSetting (settingEntry, checkpointInterval, userSettings.mCheckpointInterval));
+        cout << "A checkpoint is saved every " << userSettings.mCheckpointInterval << " generations" << endl;
+
+        userSettings.mResume = stringTOint(getSetting (settingEntry, resume, userSettings.mResume));
+        cout << "Resuming from checkpoints is set to " << userSettings.mResume << endl;
+
         // 	exit CLI when user specifies to run simulation
         stringPosition = settingEntry.find (run);
         if (stringPosition != string::npos)
@@ -7,9 +7,16 @@
 #include <sstream>
 #include <cstdio>
 #include <cstdlib>
+#include <string>
+#include <vector>
 
 using namespace std;
 
+//  formats the generation averages can be written in
+const int STATS_TEXT = 0;
+const int STATS_BINARY = 1;
+const int STATS_BOTH = 2;
+
 //	holds world environmental data
 struct varData
 {
@@ -34,10 +41,106 @@ struct varData
     //  controls magnitude of selective pressures
     int mSelectivePressureMagnitude;
 
+    //  number of clocks drawn into each mating tournament
+    int mTournamentSize;
+
+    //  how parents are chosen (SELECT_TOURNAMENT, SELECT_ROULETTE or SELECT_RANK)
+    int mSelectionMode;
+
+    //  expected number of children of the best clock under rank selection, between 1 and 2
+    double mRankPressure;
+
+    //  stop once the best and mean scores haven't improved for this many generations (0 never stops)
+    int mStallWindow;
+
+    //  stop once the best score reaches this target (0 never stops)
+    double mTargetScore;
+
+    //  stop once the coefficient of variation of the living clocks' scores falls below this (0 never stops)
+    double mMinDiversity;
+
+    //  stop once the mean share of cells that differ between two clocks' layouts falls below this (0 never stops)
+    double mMinGeneDiversity;
+
+    //  whether the generation averages are written as text, binary columns, or both (STATS_TEXT, STATS_BINARY, STATS_BOTH)
+    int mStatsFormat;
+
+    //  the console shows every 'mShowInterval'th generation, and nothing at all if it's 0
+    int mShowInterval;
+
+    //  number of processes (islands) the population is split across, 1 runs a single world
+    int mNumIslands;
+
+    //  islands exchange migrants every 'mMigrationInterval' generations
+    int mMigrationInterval;
+
+    //  number of clocks each island sends to its neighbour per exchange
+    int mNumMigrants;
+
+    //  whether the population is kept packed in a memory-mapped file instead of in memory (single worlds only), and with 2,
+    //  whether its genes are kept in tiles shared between parents and children instead
+    int mPopulationStore;
+
+    //  whether the stats files get the time each generation spent in each phase (only in a build made with 'make TIMING=1')
+    int mTiming;
+
+    //  whether the phase timings come with the hardware counters of each phase (when the system lets them be read)
+    int mPerfCounters;
+
+    //  whether the stats files get each generation's best clock, score quantiles and score histogram as well
+    int mScoreDistribution;
+
+    //  whether the stats files get the genetic diversity of each generation, the mean share of cells two clocks differ in
+    int mGeneDiversity;
+
+    //  whether every child born is written to a compressed trace that a population can be rebuilt from (single worlds only)
+    int mTrace;
+
+    //  whether who descends from whom is followed, for the line of descent of the best clock (single worlds only)
+    int mLineage;
+
+    //  seed of the random numbers, which makes a run repeat exactly when it's given again (0 seeds from /dev/urandom)
+    double mSeed;
+
+    //  a checkpoint of each simulation is saved every 'mCheckpointInterval' generations (0 saves none)
+    int mCheckpointInterval;
+
+    //  whether simulations carry on from their checkpoints instead of starting over
+    int mResume;
+
     // whether or not the user decided to quit
     bool mQuitFlag;
 };
 
+//  a setting that can be given as a flag or in a job file, and the range it has to be in
+struct settingRange
+{
+    const char * mName;
+    double mMin;
+    double mMax;
+
+    //  whether only whole numbers are allowed
+    bool mIsWhole;
+
+    //  the field it sets, whichever type that is (the other is NULL)
+    int varData::* mIntField;
+    double varData::* mDoubleField;
+};
+
+//  every setting, by the name the console uses for it
+extern const settingRange SETTING_RANGES[];
+extern const int NUM_SETTINGS;
+
+//  reads the text of a value for a setting, checking it's a number in range; returns what was wrong, or an empty string
+string readSettingValue (const settingRange & range, string text, double & value);
+
+//  sets one setting from its name and the text of its value, checking the value is a number in range;
+//  returns what was wrong, or an empty string if it was set
+string applySetting (varData & settings, string name, string text);
+
+//  sets every 'name=value' word in 'words', stopping at the first that's wrong; returns what was wrong, or an empty string
+string applySettings (varData & settings, const vector<string> & words);
+
 //	more CLI funtions
 int stringTOint (string text);
 double stringTOdouble (string text);
@@ -0,0 +1,321 @@
+//  this file defines the island model, where each process runs its own world and migrants pass through shared memory
+#include "Island.h"
+
+#include <algorithm>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+//  rounds a size up so every part of the segment starts on its own cache line
+static size_t alignSize(size_t size)
+{
+    const size_t CACHE_LINE = 64;
+
+    return (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+//  map the shared segment used by every island of the simulation
+island::island(varData settings)
+{
+    mIndex = 0;
+    mNumIslands = settings.mNumIslands;
+    mGenomeSize = settings.mGenomeSize;
+    mNumGenerations = (int)settings.mNumGenerations;
+    mNumMigrants = settings.mNumMigrants;
+    mMutationRate = settings.mMutationRate;
+    mIsJudged = hasStoppingCriteria(settings);
+    mSlotSize = alignSize(sizeof(pieceGene) * mGenomeSize * mGenomeSize);
+
+    //  lay out the status blocks, the verdicts, the rings, the migrant slots and the stats and diversity tables one after another
+    size_t statusSize = alignSize(sizeof(islandStatus) * mNumIslands);
+    size_t verdictsSize = alignSize(sizeof(islandVerdicts));
+    size_t ringSize = alignSize(sizeof(migrantRing) * mNumIslands);
+    size_t slotsSize = mSlotSize * MIGRANT_RING_SLOTS * mNumIslands;
+    size_t statsSize = alignSize(sizeof(genStats) * mNumGenerations * mNumIslands);
+    size_t diversitiesSize = alignSize(sizeof(geneDiversity) * mNumGenerations * mNumIslands);
+    mSegmentSize = statusSize + verdictsSize + ringSize + slotsSize + statsSize + diversitiesSize;
+
+    //  the name only has to live until the segment is mapped, the islands inherit the mapping when they are forked
+    stringstream segmentName;
+    segmentName << "/watchingevolution." << getpid();
+
+    int fd = shm_open(segmentName.str().c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        perror("shm_open");
+        exit(1);
+    }
+
+    if (ftruncate(fd, mSegmentSize) != 0)
+    {
+        perror("ftruncate");
+        shm_unlink(segmentName.str().c_str());
+        exit(1);
+    }
+
+    void * segment = mmap(NULL, mSegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    shm_unlink(segmentName.str().c_str());
+
+    if (segment == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(1);
+    }
+
+    mSegment = (char *)segment;
+    mStatus = (islandStatus *)mSegment;
+    mVerdicts = (islandVerdicts *)(mSegment + statusSize);
+    mRings = (migrantRing *)(mSegment + statusSize + verdictsSize);
+    mSlots = mSegment + statusSize + verdictsSize + ringSize;
+    mStats = (genStats *)(mSlots + slotsSize);
+    mDiversities = (geneDiversity *)((char *)mStats + statsSize);
+
+    //  construct the shared counters in place
+    new (mVerdicts) islandVerdicts;
+    mVerdicts->mGensJudged.store(0);
+    mVerdicts->mStopGen.store(0);
+
+    for (int i = 0; i < mNumIslands; i++)
+    {
+        new (&mStatus[i]) islandStatus;
+        mStatus[i].mGensDone.store(0);
+
+        new (&mRings[i]) migrantRing;
+        mRings[i].mHead.store(0);
+        mRings[i].mTail.store(0);
+    }
+}
+
+island::~island()
+{
+    munmap(mSegment, mSegmentSize);
+}
+
+pieceGene * island::getSlot(int ringIndex, unsigned long slotIndex)
+{
+    return (pieceGene *)(mSlots + ((size_t)ringIndex * MIGRANT_RING_SLOTS + slotIndex % MIGRANT_RING_SLOTS) * mSlotSize);
+}
+
+void island::postStats(int generation, genStats stats, geneDiversity diversity)
+{
+    mStats[(size_t)mIndex * mNumGenerations + generation] = stats;
+    mDiversities[(size_t)mIndex * mNumGenerations + generation] = diversity;
+
+    //  publish the row only after it has been written
+    mStatus[mIndex].mGensDone.store(generation + 1, memory_order_release);
+}
+
+bool island::waitForJudgement(int generation)
+{
+    if (!mIsJudged)
+        return false;
+
+    while (mVerdicts->mGensJudged.load(memory_order_acquire) <= generation)
+        usleep(100);
+
+    int stopGen = mVerdicts->mStopGen.load(memory_order_relaxed);
+    return stopGen > 0 && stopGen <= generation + 1;
+}
+
+void island::judgeGeneration(int generation, bool isLast)
+{
+    if (isLast)
+        mVerdicts->mStopGen.store(generation + 1, memory_order_relaxed);
+
+    //  publish the verdict only after the stop has been set
+    mVerdicts->mGensJudged.store(generation + 1, memory_order_release);
+}
+
+void island::exchangeMigrants(vector<bioClock> & population)
+{
+    //  sort the clocks by the scores from the last evaluation, best first
+    vector<int> order(population.size());
+    for (int i = 0; i < (signed int)order.size(); i++)
+        order[i] = i;
+
+    stable_sort(order.begin(), order.end(), [&population](int a, int b)
+    {
+        return population[a].getSurvivalScore() > population[b].getSurvivalScore();
+    });
+
+    //  collect whatever has arrived from the previous island
+    migrantRing & inbound = mRings[mIndex];
+    vector<bioClock> immigrants;
+    unsigned long head = inbound.mHead.load(memory_order_relaxed);
+    unsigned long tail = inbound.mTail.load(memory_order_acquire);
+
+    while (head != tail && immigrants.size() < population.size() / 2)
+    {
+        bioClock immigrant(mGenomeSize, getSlot(mIndex, head));
+        immigrant.setMutationRate(mMutationRate);
+        immigrants.push_back(immigrant);
+        head++;
+    }
+    inbound.mHead.store(head, memory_order_release);
+
+    //  send the best clocks on to the next island, dropping them if its ring is full so an island never waits
+    int next = (mIndex + 1) % mNumIslands;
+    migrantRing & outbound = mRings[next];
+
+    for (int i = 0; i < mNumMigrants && i < (signed int)order.size(); i++)
+    {
+        unsigned long outTail = outbound.mTail.load(memory_order_relaxed);
+        if (outTail - outbound.mHead.load(memory_order_acquire) >= (unsigned long)MIGRANT_RING_SLOTS)
+            break;
+
+        population[order[i]].getGenome(getSlot(next, outTail));
+        outbound.mTail.store(outTail + 1, memory_order_release);
+    }
+
+    //  the immigrants take the places of the worst clocks
+    for (int i = 0; i < (signed int)immigrants.size(); i++)
+        population[order[order.size() - 1 - i]] = immigrants[i];
+}
+
+void runIslands(varData settings, int simNumber)
+{
+    //  every island needs enough clocks to hold a tournament
+    if (settings.mNumIslands > settings.mPopulationSize / 3)
+        settings.mNumIslands = max(1, (int)(settings.mPopulationSize / 3));
+    if (settings.mMigrationInterval < 1)
+        settings.mMigrationInterval = 1;
+
+    island shared(settings);
+    vector<pid_t> children(settings.mNumIslands, -1);
+    vector<bool> isRunning(settings.mNumIslands, false);
+    int numRunning = 0;
+
+    //  anything still buffered would be printed again by every child
+    cout.flush();
+
+    for (int i = 0; i < settings.mNumIslands; i++)
+    {
+        pid_t pid = fork();
+
+        if (pid == 0)
+        {
+            //  split the population evenly, giving any remainder to the first islands
+            varData islandSettings = settings;
+            int population = (int)settings.mPopulationSize;
+            islandSettings.mPopulationSize = population / settings.mNumIslands + (i < population % settings.mNumIslands);
+
+            //  each island draws its own random numbers, rather than repeating the ones its parent would have drawn next
+            //  (seeding them doesn't make an island run repeat, since when migrants arrive depends on how the processes run)
+            if (settings.mSeed > 0)
+                seedSimRand((unsigned long)settings.mSeed, simNumber, i + 1);
+            else
+                simRand().seed();
+
+            shared.setIndex(i);
+            world simulation(islandSettings, &shared);
+            simulation.initClocks();
+            simulation.mateClocks();
+
+            cout.flush();
+            _exit(0);
+        }
+        else if (pid < 0)
+        {
+            perror("fork");
+            break;
+        }
+
+        children[i] = pid;
+        isRunning[i] = true;
+        numRunning++;
+    }
+
+    //  the coordinator writes the merged averages as soon as every running island has finished a generation
+    //  (it doesn't have the islands' clocks, and the islands' own distributions and diversities can't be put together
+    //  into the whole population's, since each bins by its own highest score and leaves out every pair between two
+    //  islands, so those columns say they weren't measured rather than give numbers for the whole population)
+    world coordinator(settings);
+    coordinator.setPopulationUnseen();
+    coordinator.createOutputFile(simNumber);
+    coordinator.outputSettings();
+    int nextGen = 0;
+
+    while (nextGen < settings.mNumGenerations)
+    {
+        //  collect islands that have exited, so one crashing doesn't hold up the others
+        for (int i = 0; i < settings.mNumIslands; i++)
+        {
+            int status;
+            if (isRunning[i] && waitpid(children[i], &status, WNOHANG) == children[i])
+            {
+                isRunning[i] = false;
+                numRunning--;
+
+                //  the rows after the island's last generation only count the clocks of the others, which the file says
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                {
+                    cout << endl << "Island " << i + 1 << " stopped after generation " << shared.getGensDone(i) << endl;
+                    coordinator.outputComment("island " + to_string(i + 1) + " stopped after generation " + to_string(shared.getGensDone(i))
+                        + ", so the rows after that only count the other islands");
+                }
+            }
+        }
+
+        while (nextGen < settings.mNumGenerations)
+        {
+            bool isReady = true;
+            for (int i = 0; i < settings.mNumIslands; i++)
+                isReady = isReady && !(isRunning[i] && shared.getGensDone(i) <= nextGen);
+
+            if (!isReady)
+                break;
+
+            genStats merged;
+            for (int i = 0; i < settings.mNumIslands; i++)
+                if (shared.getGensDone(i) > nextGen)
+                    merged.merge(shared.getStats(i, nextGen));
+
+            //  no island got this far
+            if (merged.mNumClocks == 0)
+            {
+                nextGen = settings.mNumGenerations;
+                break;
+            }
+
+            coordinator.outputGenAverages(merged, nextGen);
+
+            //  the stopping criteria are checked once, on the whole population, so every island stops after the same
+            //  generation (only the islands see their genomes, so the gene diversity checked is the most diverse island's)
+            geneDiversity diversity = {0, 0};
+            for (int i = 0; i < settings.mNumIslands; i++)
+            {
+                geneDiversity islandDiversity = shared.getDiversity(i, nextGen);
+                if (shared.getGensDone(i) > nextGen && islandDiversity.mNumPairs > 0 && (diversity.mNumPairs == 0 || islandDiversity.mDiversity > diversity.mDiversity))
+                    diversity = islandDiversity;
+            }
+
+            string stopReason = hasStoppingCriteria(settings) ? coordinator.checkConvergence(merged, diversity) : "";
+            shared.judgeGeneration(nextGen, !stopReason.empty());
+            nextGen++;
+
+            if (!stopReason.empty())
+            {
+                coordinator.outputStop(nextGen, stopReason);
+                nextGen = settings.mNumGenerations;
+            }
+        }
+
+        if (numRunning == 0)
+            break;
+
+        //  islands waiting on every verdict are held up by however long this sleeps
+        usleep(hasStoppingCriteria(settings) ? 100 : 1000);
+    }
+
+    //  wait for any island that is still finishing up
+    for (int i = 0; i < settings.mNumIslands; i++)
+        if (isRunning[i])
+            waitpid(children[i], NULL, 0);
+
+    coordinator.closeOutputFile();
+}
@@ -0,0 +1,112 @@
+//  this file contains the island model, which splits one simulation across several processes on the same machine
+
+#ifndef ISLAND_H_INCLUDED
+#define ISLAND_H_INCLUDED
+
+#include "Evolve.h"
+#include <atomic>
+
+using namespace std;
+
+//  number of migrant slots in each island's inbound ring
+const int MIGRANT_RING_SLOTS = 64;
+
+//  shared progress of one island, written by that island and read by the coordinator
+struct islandStatus
+{
+    //  generations whose totals have been posted
+    atomic<int> mGensDone;
+};
+
+//  the coordinator's verdicts on the generations, which every island waits for when a run can stop early, so they all stop
+//  after the same one
+struct islandVerdicts
+{
+    //  generations the coordinator has checked the stopping criteria of
+    atomic<int> mGensJudged;
+
+    //  the generation the run stops after (0 until it's been told to stop)
+    atomic<int> mStopGen;
+};
+
+//  single-producer/single-consumer ring of migrants travelling into one island
+struct migrantRing
+{
+    //  next slot to read (only moved by the receiving island)
+    atomic<unsigned long> mHead;
+
+    //  next slot to write (only moved by the sending island)
+    atomic<unsigned long> mTail;
+};
+
+//  one island's view of the shared-memory segment that connects all of the island processes
+class island
+{
+private:
+
+    //  which island this is, and how many there are
+    int mIndex;
+    int mNumIslands;
+
+    //  settings that size the shared segment
+    int mGenomeSize;
+    int mNumGenerations;
+    int mNumMigrants;
+    double mMutationRate;
+
+    //  whether the islands wait for the coordinator's verdict after every generation
+    bool mIsJudged;
+
+    //  the mapped segment and its parts
+    char * mSegment;
+    size_t mSegmentSize;
+    islandStatus * mStatus;
+    islandVerdicts * mVerdicts;
+    migrantRing * mRings;
+    char * mSlots;
+    genStats * mStats;
+    geneDiversity * mDiversities;
+
+    //  bytes taken up by one migrant slot
+    size_t mSlotSize;
+
+    //  returns a slot of an island's inbound ring
+    pieceGene * getSlot(int ringIndex, unsigned long slotIndex);
+
+    //  the segment is unmapped by its owner, so it can't be copied
+    island (const island &);
+    island & operator= (const island &);
+
+public:
+
+    //  maps a new shared segment big enough for every island in the settings
+    island (varData settings);
+    ~island();
+
+    //  selects which island the calling process is
+    void setIndex(int index) {mIndex = index;};
+
+    //  stores the totals and gene diversity of a finished generation for the coordinator
+    void postStats(int generation, genStats stats, geneDiversity diversity);
+
+    //  waits (if the run can stop early) until the coordinator has checked a generation, returning whether it's the last
+    bool waitForJudgement(int generation);
+
+    //  gives the coordinator's verdict on a generation to the islands waiting for it
+    void judgeGeneration(int generation, bool isLast);
+
+    //  sends the best clocks to the next island and replaces the worst clocks with any migrants that have arrived
+    void exchangeMigrants(vector<bioClock> & population);
+
+    //  number of generations an island has finished
+    int getGensDone(int index) {return mStatus[index].mGensDone.load(memory_order_acquire);};
+
+    //  returns the totals an island posted for a generation
+    genStats getStats(int index, int generation) {return mStats[(size_t)index * mNumGenerations + generation];};
+    geneDiversity getDiversity(int index, int generation) {return mDiversities[(size_t)index * mNumGenerations + generation];};
+};
+
+//  forks one process per island, waits for them, and writes the merged generation averages of simulation 'simNumber'
+void runIslands(varData settings, int simNumber);
+
+#endif // ISLAND_H_INCLUDED
@@ -0,0 +1,168 @@
+//  this file defines the batch runner
+#include "Jobs.h"
+#include "Evolve.h"
+#include "Island.h"
+
+#include <fstream>
+
+using namespace std;
+
+void runSimulations(varData settings, int firstSimNumber)
+{
+    for (int i = 0; i < settings.mSimTimes; i++)
+    {
+        int simNumber = firstSimNumber + i;
+
+        //  split the simulation into island processes if asked to
+        if (settings.mNumIslands > 1)
+        {
+            runIslands(settings, simNumber);
+            continue;
+        }
+
+    	//	make the world
+        world simulation (settings);
+
+        //  carry on from the simulation's checkpoint if there is one, skipping it if it had already finished
+        if (settings.mResume && simulation.loadCheckpoint(simNumber))
+        {
+            if (simulation.isFinished())
+            {
+                cout << endl << "Simulation " << simNumber << " had already finished" << endl;
+                continue;
+            }
+
+            cout << endl << "Simulation " << simNumber << " carries on after generation " << simulation.getGensRun() << endl;
+            simulation.createOutputFile(simNumber, true);
+        }
+        else
+        {
+            //  open the output files and write the settings at the top
+            simulation.createOutputFile(simNumber);
+            simulation.outputSettings();
+
+            //  a seeded simulation draws the same random numbers every time it's run
+            if (settings.mSeed > 0)
+                seedSimRand((unsigned long)settings.mSeed, simNumber);
+
+            //	initialize clocks
+            simulation.initClocks();
+        }
+
+        //	mate them
+        simulation.mateClocks();
+
+        //	close output file
+        simulation.closeOutputFile();
+    }
+}
+
+bool readFlags(int argc, char * argv[], varData & settings)
+{
+    for (int i = 0; i < argc; i++)
+    {
+        string flag = argv[i];
+        if (flag.compare(0, 2, "--") != 0)
+        {
+            cerr << "'" << flag << "' isn't a flag (flags look like --pop=1000)" << endl;
+            return false;
+        }
+
+        //  the value follows an '=', or is the next argument
+        string name = flag.substr(2);
+        string text;
+        size_t split = name.find('=');
+        if (split != string::npos)
+        {
+            text = name.substr(split + 1);
+            name = name.substr(0, split);
+        }
+        else if (i + 1 < argc)
+            text = argv[++i];
+
+        string error = applySetting(settings, name, text);
+        if (!error.empty())
+        {
+            cerr << "--" << name << ": " << error << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void writeFlagHelp()
+{
+    cout << "usage: watchingevolution [--name=value ...]" << endl;
+    cout << "       watchingevolution jobs <file> [--name=value ...]" << endl;
+    cout << "       watchingevolution sweep name=values ..." << endl;
+    cout << "       watchingevolution replay [--only=name,name] [--reps=N] [--out=file.csv] [--compare=file.csv]" << endl << endl;
+
+    for (int i = 0; i < NUM_SETTINGS; i++)
+        cout << "  --" << SETTING_RANGES[i].mName << " [" << (long long)SETTING_RANGES[i].mMin << " - " << (long long)SETTING_RANGES[i].mMax << "]"
+        << (SETTING_RANGES[i].mIsWhole ? "" : " (decimals allowed)") << endl;
+}
+
+int runJobFile(int argc, char * argv[])
+{
+    if (argc < 1)
+    {
+        cerr << "usage: watchingevolution jobs <file> [--name=value ...]" << endl;
+        return 1;
+    }
+
+    //  the flags are the base every job starts from
+    varData baseSettings;
+    if (!readFlags(argc - 1, argv + 1, baseSettings))
+        return 1;
+
+    ifstream jobFile(argv[0]);
+    if (!jobFile)
+    {
+        cerr << "Can't read job file '" << argv[0] << "'" << endl;
+        return 1;
+    }
+
+    //  every line is read and checked before anything runs, so a mistake near the end doesn't waste the jobs before it
+    vector<varData> jobs;
+    vector<int> jobLines;
+    string line;
+
+    for (int lineNumber = 1; getline(jobFile, line); lineNumber++)
+    {
+        line = line.substr(0, line.find('#'));
+
+        stringstream words(line);
+        vector<string> settings;
+        string word;
+        while (words >> word)
+            settings.push_back(word);
+
+        if (settings.empty())
+            continue;
+
+        varData job = baseSettings;
+        string error = applySettings(job, settings);
+        if (!error.empty())
+        {
+            cerr << argv[0] << ":" << lineNumber << ": " << error << endl;
+            return 1;
+        }
+
+        jobs.push_back(job);
+        jobLines.push_back(lineNumber);
+    }
+
+    //  the jobs share this process, so the random number generator and thread pools carry on from one to the next
+    int simNumber = 1;
+    for (int i = 0; i < (signed int)jobs.size(); i++)
+    {
+        cout << endl << "Job " << i + 1 << " of " << jobs.size() << " (line " << jobLines[i] << ") runs simulations " << simNumber
+        << " to " << simNumber + jobs[i].mSimTimes - 1 << endl;
+
+        runSimulations(jobs[i], simNumber);
+        simNumber += jobs[i].mSimTimes;
+    }
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+//  this file contains the batch runner, which takes its settings from flags or a job file instead of the console
+
+#ifndef JOBS_H_INCLUDED
+#define JOBS_H_INCLUDED
+
+#include "Interface.h"
+
+using namespace std;
+
+/*
+FLAGS AND JOB FILES:
+
+    watchingevolution --pop=1000 --gens=500 ...      runs once with the flags' settings, without the console
+    watchingevolution jobs <file> [--name=value ...] runs every job in a job file, one after another in this process
+
+Flags and job settings use the console's names, and each value has to be a number in the setting's range. A job
+file has one job per line, as 'name=value' words separated by spaces, on top of the defaults and any flags. Blank
+lines and anything after a '#' are skipped. The whole file is checked before any job starts.
+
+Simulations are numbered on from one job to the next, so every job's output files get names of their own.
+*/
+
+//  runs a setting's simulations, numbering them from 'firstSimNumber'
+void runSimulations(varData settings, int firstSimNumber);
+
+//  reads '--name=value' and '--name value' flags into 'settings'; returns false (having said why) if one is wrong
+bool readFlags(int argc, char * argv[], varData & settings);
+
+//  prints every flag and its range
+void writeFlagHelp();
+
+//  runs a job file with flags for every job, returning the exit code
+int runJobFile(int argc, char * argv[]);
+
+#endif // JOBS_H_INCLUDED
@@ -0,0 +1,198 @@
+//  this file defines the lineage tree
+#include "Lineage.h"
+
+#include <algorithm>
+
+using namespace std;
+
+//  the tree is never compacted while it's smaller than this
+const long MIN_COMPACT_SIZE = 1024;
+
+lineageTree::lineageTree()
+{
+    mNextId = 0;
+    mCompactSize = MIN_COMPACT_SIZE;
+}
+
+void lineageTree::start(int populationSize)
+{
+    mNodes.clear();
+    mFreeNodes.clear();
+    mBornSlots.clear();
+    mBornNodes.clear();
+    mNextId = 0;
+
+    mLiving.resize(populationSize);
+    for (int i = 0; i < populationSize; i++)
+        mLiving[i] = newNode(-1, NO_PARENT_ID, 0);
+
+    mCompactSize = max(MIN_COMPACT_SIZE, 4 * (long)populationSize);
+}
+
+int lineageTree::newNode(int parent, uint32_t secondParentId, int generation)
+{
+    lineageNode node = {mNextId++, secondParentId, generation, parent, 1, 1};
+
+    if (parent >= 0)
+        mNodes[parent].mRefs++;
+
+    if (mFreeNodes.empty())
+    {
+        mNodes.push_back(node);
+        return (int)mNodes.size() - 1;
+    }
+
+    int index = mFreeNodes.back();
+    mFreeNodes.pop_back();
+    mNodes[index] = node;
+
+    return index;
+}
+
+void lineageTree::release(int node)
+{
+    //  a whole extinct branch is freed without recursing down it
+    while (node >= 0 && --mNodes[node].mRefs == 0)
+    {
+        int parent = mNodes[node].mParent;
+        mNodes[node].mRefs = -1;
+        mFreeNodes.push_back(node);
+        node = parent;
+    }
+}
+
+void lineageTree::addChild(int slot, int parent1, int parent2, int generation)
+{
+    mBornSlots.push_back(slot);
+    mBornNodes.push_back(newNode(mLiving[parent1], mNodes[mLiving[parent2]].mId, generation));
+}
+
+void lineageTree::commit()
+{
+    for (int i = 0; i < (signed int)mBornSlots.size(); i++)
+    {
+        int dead = mLiving[mBornSlots[i]];
+        mLiving[mBornSlots[i]] = mBornNodes[i];
+
+        mNodes[dead].mIsLiving = 0;
+        release(dead);
+    }
+
+    mBornSlots.clear();
+    mBornNodes.clear();
+
+    if (size() >= mCompactSize)
+        compact();
+}
+
+void lineageTree::compact()
+{
+    for (int i = 0; i < (signed int)mNodes.size(); i++)
+    {
+        if (mNodes[i].mRefs < 0)
+            continue;
+
+        //  a dead parent that only this node leads back to is skipped, handing its own reference on
+        int parent = mNodes[i].mParent;
+        while (parent >= 0 && !mNodes[parent].mIsLiving && mNodes[parent].mRefs == 1)
+        {
+            int grandparent = mNodes[parent].mParent;
+            mNodes[parent].mRefs = -1;
+            mFreeNodes.push_back(parent);
+            parent = grandparent;
+        }
+        mNodes[i].mParent = parent;
+    }
+
+    //  what's left is at most twice the population, so compacting again waits until the tree has grown as much again
+    mCompactSize = max(MIN_COMPACT_SIZE, max(2 * size(), 4 * (long)mLiving.size()));
+}
+
+int lineageTree::findCommonAncestor(int node1, int node2)
+{
+    //  parents always have lower IDs than their children, so the later of the two steps back until they meet
+    while (node1 != node2 && node1 >= 0 && node2 >= 0)
+    {
+        if (mNodes[node1].mId > mNodes[node2].mId)
+            node1 = mNodes[node1].mParent;
+        else
+            node2 = mNodes[node2].mParent;
+    }
+
+    return (node1 == node2) ? node1 : -1;
+}
+
+bool lineageTree::getCommonAncestor(int slot1, int slot2, lineageNode & ancestor)
+{
+    int node = findCommonAncestor(mLiving[slot1], mLiving[slot2]);
+    if (node < 0)
+        return false;
+
+    ancestor = mNodes[node];
+    return true;
+}
+
+bool lineageTree::getPopulationAncestor(lineageNode & ancestor)
+{
+    int node = mLiving.empty() ? -1 : mLiving[0];
+    for (int i = 1; i < (signed int)mLiving.size() && node >= 0; i++)
+        node = findCommonAncestor(node, mLiving[i]);
+
+    if (node < 0)
+        return false;
+
+    ancestor = mNodes[node];
+    return true;
+}
+
+void lineageTree::getLineOfDescent(int slot, vector<lineageNode> & line)
+{
+    line.clear();
+    for (int node = mLiving[slot]; node >= 0; node = mNodes[node].mParent)
+        line.push_back(mNodes[node]);
+}
+
+//  the size the tree is next compacted at and the order the free places are handed out in are saved as well, since the
+//  ancestors kept (and so the line of descent written) depend on when it was compacted
+void lineageTree::saveState(ostream & out)
+{
+    uint32_t sizes[3] = {(uint32_t)mNodes.size(), (uint32_t)mLiving.size(), (uint32_t)mFreeNodes.size()};
+    int64_t compactSize = mCompactSize;
+    out.write((const char *)sizes, sizeof(sizes));
+    out.write((const char *)&mNextId, sizeof(mNextId));
+    out.write((const char *)&compactSize, sizeof(compactSize));
+
+    if (!mNodes.empty())
+        out.write((const char *)&mNodes[0], mNodes.size() * sizeof(lineageNode));
+    if (!mLiving.empty())
+        out.write((const char *)&mLiving[0], mLiving.size() * sizeof(int));
+    if (!mFreeNodes.empty())
+        out.write((const char *)&mFreeNodes[0], mFreeNodes.size() * sizeof(int));
+}
+
+bool lineageTree::loadState(istream & in)
+{
+    uint32_t sizes[3] = {0, 0, 0};
+    int64_t compactSize = MIN_COMPACT_SIZE;
+    in.read((char *)sizes, sizeof(sizes));
+    in.read((char *)&mNextId, sizeof(mNextId));
+    in.read((char *)&compactSize, sizeof(compactSize));
+    if (!in || sizes[2] > sizes[0])
+        return false;
+
+    mNodes.resize(sizes[0]);
+    mLiving.resize(sizes[1]);
+    mFreeNodes.resize(sizes[2]);
+    if (!mNodes.empty())
+        in.read((char *)&mNodes[0], mNodes.size() * sizeof(lineageNode));
+    if (!mLiving.empty())
+        in.read((char *)&mLiving[0], mLiving.size() * sizeof(int));
+    if (!mFreeNodes.empty())
+        in.read((char *)&mFreeNodes[0], mFreeNodes.size() * sizeof(int));
+
+    mBornSlots.clear();
+    mBornNodes.clear();
+    mCompactSize = (long)compactSize;
+
+    return (bool)in;
+}
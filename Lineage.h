@@ -0,0 +1,100 @@
+//  this file contains the lineage tree, which follows who descends from whom without keeping every clock that ever lived
+
+#ifndef LINEAGE_H_INCLUDED
+#define LINEAGE_H_INCLUDED
+
+#include <iostream>
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+/*
+Every clock born gets an ID, counting up from 0 for the first generation. The tree follows each clock back through
+its first parent (the tournament winner, or the first drawn), and keeps the second parent's ID alone, since following
+both parents keeps nearly every clock that ever lived.
+
+A clock that has died stays in the tree only while a living clock descends from it. Once just one line runs through a
+dead clock it's cut out of that line, so what's kept is the living clocks and the ancestors where their lines meet,
+which is never more than twice the population.
+*/
+
+//  one clock in the tree
+struct lineageNode
+{
+    uint32_t mId;
+    uint32_t mSecondParentId;
+    int32_t mGeneration;
+
+    //  where the first parent (or the nearest ancestor kept) is in the tree, or -1 for the first generation
+    int32_t mParent;
+
+    //  children that lead back to it, plus one while it's alive (-1 for a free place in the tree)
+    int32_t mRefs;
+    int32_t mIsLiving;
+};
+
+//  ID given as the second parent of the first generation
+const uint32_t NO_PARENT_ID = 0xFFFFFFFF;
+
+//  the ancestry of a population, with a place in the tree for each slot of the population
+class lineageTree
+{
+private:
+
+    vector<lineageNode> mNodes;
+    vector<int> mFreeNodes;
+
+    //  the node of the clock in each slot, and children waiting to take their slots
+    vector<int> mLiving;
+    vector<int> mBornSlots;
+    vector<int> mBornNodes;
+
+    uint32_t mNextId;
+
+    //  the tree is compacted once it grows to this many nodes
+    long mCompactSize;
+
+    int newNode(int parent, uint32_t secondParentId, int generation);
+
+    //  drops a reference, freeing the node and whatever ancestors only it led back to
+    void release(int node);
+
+    //  cuts dead clocks that lead back to one child out of every line
+    void compact();
+
+    int findCommonAncestor(int node1, int node2);
+
+public:
+
+    lineageTree();
+
+    //  starts a tree with a first generation of 'populationSize' clocks
+    void start(int populationSize);
+    bool isStarted() {return !mLiving.empty();};
+
+    //  records a child of the clocks in two slots, which takes slot 'slot' at the next commit()
+    void addChild(int slot, int parent1, int parent2, int generation);
+
+    //  puts the children born since the last commit in their slots
+    void commit();
+
+    //  the clock in a slot
+    const lineageNode & getClock(int slot) {return mNodes[mLiving[slot]];};
+
+    //  finds the latest ancestor shared by the clocks in two slots, or by every clock; returns false if there isn't one yet
+    bool getCommonAncestor(int slot1, int slot2, lineageNode & ancestor);
+    bool getPopulationAncestor(lineageNode & ancestor);
+
+    //  fills 'line' with the ancestors kept for the clock in a slot, from it back to the first generation
+    void getLineOfDescent(int slot, vector<lineageNode> & line);
+
+    //  number of clocks kept, living and dead
+    long size() {return (long)(mNodes.size() - mFreeNodes.size());};
+
+    //  writes and reads the whole tree, for checkpoints
+    void saveState(ostream & out);
+    bool loadState(istream & in);
+};
+
+#endif // LINEAGE_H_INCLUDED
@@ -0,0 +1,120 @@
+//  this file defines the hardware performance counters
+#include "PerfCounters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+//  the perf_event_attr config of each event, in the order of PERF_COUNTER_NAMES
+static const uint64_t PERF_CONFIGS[NUM_PERF_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+perfCounters::perfCounters()
+{
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        mFiles[i] = -1;
+        mPlaces[i] = -1;
+    }
+    mLeader = -1;
+    mNumCounting = 0;
+}
+
+perfCounters::~perfCounters()
+{
+    close();
+}
+
+bool perfCounters::open()
+{
+    if (isOpen())
+        return true;
+
+    mError.clear();
+    bool isRefused = false;
+
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        struct perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = PERF_CONFIGS[i];
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        //  the leader starts disabled, so the whole group starts counting together
+        attributes.disabled = (mLeader < 0) ? 1 : 0;
+
+        int file = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, mLeader, 0);
+        if (file < 0)
+        {
+            //  an event this processor doesn't have is left out; anything else means counters aren't allowed at all
+            if (mError.empty())
+                mError = string(PERF_COUNTER_NAMES[i]) + ": " + strerror(errno);
+            if (errno == EACCES || errno == EPERM)
+            {
+                isRefused = true;
+                break;
+            }
+            continue;
+        }
+
+        mFiles[i] = file;
+        mPlaces[i] = mNumCounting++;
+        if (mLeader < 0)
+            mLeader = file;
+    }
+
+    if (mLeader < 0 || isRefused)
+    {
+        close();
+        if (mError.empty())
+            mError = "no counters could be opened";
+        return false;
+    }
+
+    ioctl(mLeader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(mLeader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    return true;
+}
+
+void perfCounters::close()
+{
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        if (mFiles[i] >= 0)
+            ::close(mFiles[i]);
+        mFiles[i] = -1;
+        mPlaces[i] = -1;
+    }
+    mLeader = -1;
+    mNumCounting = 0;
+}
+
+bool perfCounters::read(int64_t * values)
+{
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+        values[i] = 0;
+
+    if (!isOpen())
+        return false;
+
+    //  a group read gives the number of events, the time enabled and the time counting, then each event's count
+    uint64_t data[3 + NUM_PERF_COUNTERS];
+    ssize_t size = ::read(mLeader, data, sizeof(data));
+    if (size < (ssize_t)(3 * sizeof(uint64_t)) || data[0] != (uint64_t)mNumCounting)
+        return false;
+
+    double scale = (data[2] > 0 && data[2] < data[1]) ? (double)data[1] / data[2] : 1;
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+        if (mPlaces[i] >= 0)
+            values[i] = (int64_t)(data[3 + mPlaces[i]] * scale);
+
+    return true;
+}
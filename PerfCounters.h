@@ -0,0 +1,56 @@
+//  this file contains the hardware performance counters, read through Linux's perf_event_open()
+
+#ifndef PERFCOUNTERS_H_INCLUDED
+#define PERFCOUNTERS_H_INCLUDED
+
+#include <stdint.h>
+#include <string>
+
+using namespace std;
+
+/*
+The counters follow the thread that opens them, counting in user space only. They're opened as one group so they're
+all counting over the same stretch, and if the processor has to share them out between more events than it can count
+at once, the values read are scaled up by how long they were actually counting.
+
+Containers and locked-down kernels often don't allow hardware counters at all (perf_event_open() fails with EACCES,
+EPERM or ENOENT). Then open() returns false with the reason in getError(), and whoever wanted the counters carries on
+without them. A single event the processor doesn't have is left out, and reads as 0, without losing the others.
+*/
+
+//  the events counted
+enum perfCounter {PERF_CYCLES, PERF_INSTRUCTIONS, PERF_CACHE_MISSES, PERF_BRANCH_MISSES, NUM_PERF_COUNTERS};
+const char * const PERF_COUNTER_NAMES[NUM_PERF_COUNTERS] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+
+class perfCounters
+{
+private:
+
+    //  file of each event (-1 for one that isn't counted), the first one counted leading the group
+    int mFiles[NUM_PERF_COUNTERS];
+    int mLeader;
+
+    //  place of each event in what a read of the group returns
+    int mPlaces[NUM_PERF_COUNTERS];
+    int mNumCounting;
+
+    string mError;
+
+public:
+
+    perfCounters();
+    ~perfCounters();
+
+    //  starts counting the calling thread, returning false (and why, in getError()) if the counters can't be used
+    bool open();
+    void close();
+
+    bool isOpen() {return mLeader >= 0;};
+    bool isCounting(perfCounter counter) {return mFiles[counter] >= 0;};
+    string getError() {return mError;};
+
+    //  reads the totals counted since open(), in the order of PERF_COUNTER_NAMES
+    bool read(int64_t * values);
+};
+
+#endif // PERFCOUNTERS_H_INCLUDED
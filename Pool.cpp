@@ -0,0 +1,126 @@
+//  this file defines the work-stealing thread pool
+#include "Pool.h"
+
+using namespace std;
+
+workPool::workPool(int numThreads)
+{
+    if (numThreads <= 0)
+        numThreads = max(1, (int)thread::hardware_concurrency());
+
+    mPending.store(0);
+    mQueued.store(0);
+    mNextQueue = 0;
+    mIsStopping = false;
+
+    for (int i = 0; i < numThreads; i++)
+        mQueues.push_back(unique_ptr<workQueue>(new workQueue));
+
+    for (int i = 0; i < numThreads; i++)
+        mThreads.push_back(thread(&workPool::runWorker, this, i));
+}
+
+workPool::~workPool()
+{
+    {
+        lock_guard<mutex> guard(mLock);
+        mIsStopping = true;
+    }
+    mWake.notify_all();
+
+    for (int i = 0; i < (signed int)mThreads.size(); i++)
+        mThreads[i].join();
+}
+
+void workPool::submit(function<void()> task)
+{
+    int index;
+
+    {
+        lock_guard<mutex> guard(mLock);
+        index = mNextQueue;
+        mNextQueue = (mNextQueue + 1) % mQueues.size();
+        mPending++;
+    }
+
+    {
+        lock_guard<mutex> guard(mQueues[index]->mLock);
+        mQueues[index]->mTasks.push_back(task);
+    }
+
+    //  count it under the pool lock so a worker can't miss the wake-up between checking the queues and going to sleep
+    {
+        lock_guard<mutex> guard(mLock);
+        mQueued++;
+    }
+    mWake.notify_all();
+}
+
+void workPool::wait()
+{
+    unique_lock<mutex> guard(mLock);
+    mDone.wait(guard, [this]() {return mPending.load() == 0;});
+}
+
+bool workPool::takeTask(int index, function<void()> & task)
+{
+    //  a worker runs its own tasks in the order they were dealt out
+    {
+        lock_guard<mutex> guard(mQueues[index]->mLock);
+        if (!mQueues[index]->mTasks.empty())
+        {
+            task = mQueues[index]->mTasks.front();
+            mQueues[index]->mTasks.pop_front();
+            mQueued--;
+            return true;
+        }
+    }
+
+    //  otherwise it steals from the other end of someone else's queue
+    for (int i = 1; i < (signed int)mQueues.size(); i++)
+    {
+        workQueue & victim = *mQueues[(index + i) % mQueues.size()];
+        lock_guard<mutex> guard(victim.mLock);
+
+        if (!victim.mTasks.empty())
+        {
+            task = victim.mTasks.back();
+            victim.mTasks.pop_back();
+            mQueued--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void workPool::runWorker(int index)
+{
+    function<void()> task;
+
+    while (true)
+    {
+        if (takeTask(index, task))
+        {
+            task();
+            task = nullptr;
+
+            //  wake anyone waiting once the last task is done
+            if (--mPending == 0)
+            {
+                lock_guard<mutex> guard(mLock);
+                mDone.notify_all();
+            }
+            continue;
+        }
+
+        //  nothing to run or steal, so sleep until there is
+        unique_lock<mutex> guard(mLock);
+        if (mIsStopping)
+            return;
+
+        mWake.wait(guard, [this]() {return mIsStopping || mQueued.load() > 0;});
+        if (mIsStopping && mQueued.load() == 0)
+            return;
+    }
+}
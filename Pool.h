@@ -0,0 +1,70 @@
+//  this file contains the work-stealing thread pool that runs independent jobs across every core
+
+#ifndef POOL_H_INCLUDED
+#define POOL_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+//  a pool of worker threads, each with its own queue of tasks that idle workers can steal from
+class workPool
+{
+private:
+
+    //  one worker's tasks
+    struct workQueue
+    {
+        mutex mLock;
+        deque< function<void()> > mTasks;
+    };
+
+    vector<thread> mThreads;
+    vector< unique_ptr<workQueue> > mQueues;
+
+    //  tasks submitted but not yet finished, and those not yet taken by a worker
+    atomic<int> mPending;
+    atomic<int> mQueued;
+
+    //  queue that the next submitted task goes to
+    int mNextQueue;
+
+    //  used to put idle workers to sleep, and to wake whoever is waiting for the pool to empty
+    mutex mLock;
+    condition_variable mWake;
+    condition_variable mDone;
+    bool mIsStopping;
+
+    //  the loop each worker thread runs
+    void runWorker(int index);
+
+    //  takes the front task of a worker's own queue, or steals the back task of another's
+    bool takeTask(int index, function<void()> & task);
+
+    //  the pool owns its threads, so it can't be copied
+    workPool (const workPool &);
+    workPool & operator= (const workPool &);
+
+public:
+
+    //  starts the workers (0 starts one per hardware thread)
+    workPool (int numThreads = 0);
+    ~workPool();
+
+    //  queues a task, dealing tasks out to the workers in turn so that tasks submitted in order of cost stay spread out
+    void submit(function<void()> task);
+
+    //  blocks until every submitted task has finished
+    void wait();
+
+    int size() {return (int)mThreads.size();};
+};
+
+#endif // POOL_H_INCLUDED
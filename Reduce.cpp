@@ -0,0 +1,95 @@
+//  this file defines the score distribution
+#include "Reduce.h"
+
+#include <cmath>
+
+using namespace std;
+
+//  what a block of clocks hands back on the first pass: its scores in order, and its best clock
+struct scoreBlock
+{
+    vector<double> mScores;
+    long mBestClock;
+    double mBestScore;
+};
+
+//  a block's histogram on the second pass
+struct binBlock
+{
+    long mBins[NUM_SCORE_BINS];
+};
+
+void calcScoreDistribution(workPool * pool, long size, function<bool(long, double &)> getScore, scoreDistribution & distribution)
+{
+    //  gather the scores, keeping the first best clock of each block
+    scoreBlock initialScores = {vector<double>(), -1, 0};
+    scoreBlock scores = reduceBlocks(pool, size, initialScores,
+        [&getScore](long begin, long end, scoreBlock & block)
+        {
+            block.mScores.reserve(end - begin);
+            for (long i = begin; i < end; i++)
+            {
+                double score;
+                if (!getScore(i, score))
+                    continue;
+
+                block.mScores.push_back(score);
+                if (block.mBestClock < 0 || score > block.mBestScore)
+                {
+                    block.mBestClock = i;
+                    block.mBestScore = score;
+                }
+            }
+        },
+        [](scoreBlock & total, const scoreBlock & block)
+        {
+            total.mScores.insert(total.mScores.end(), block.mScores.begin(), block.mScores.end());
+            if (block.mBestClock >= 0 && (total.mBestClock < 0 || block.mBestScore > total.mBestScore))
+            {
+                total.mBestClock = block.mBestClock;
+                total.mBestScore = block.mBestScore;
+            }
+        });
+
+    distribution.mBestClock = scores.mBestClock;
+    for (int i = 0; i < NUM_SCORE_QUANTILES; i++)
+        distribution.mQuantiles[i] = 0;
+    for (int i = 0; i < NUM_SCORE_BINS; i++)
+        distribution.mBins[i] = 0;
+
+    long numScores = (long)scores.mScores.size();
+    if (numScores == 0)
+        return;
+
+    //  quantiles are interpolated between the two nearest scores
+    vector<double> & sorted = scores.mScores;
+    sort(sorted.begin(), sorted.end());
+    for (int i = 0; i < NUM_SCORE_QUANTILES; i++)
+    {
+        double position = (double)i / (NUM_SCORE_QUANTILES - 1) * (numScores - 1);
+        long below = (long)floor(position);
+        long above = min(below + 1, numScores - 1);
+        distribution.mQuantiles[i] = sorted[below] + (position - below) * (sorted[above] - sorted[below]);
+    }
+
+    //  the histogram covers 0 to the highest score, and its counts add up the same whichever order the blocks come in
+    double highest = sorted.back();
+    binBlock initialBins = {{0}};
+    binBlock bins = reduceBlocks(pool, numScores, initialBins,
+        [&sorted, highest](long begin, long end, binBlock & block)
+        {
+            for (long i = begin; i < end; i++)
+            {
+                int bin = (highest > 0) ? (int)(sorted[i] / highest * NUM_SCORE_BINS) : 0;
+                block.mBins[min(max(bin, 0), NUM_SCORE_BINS - 1)]++;
+            }
+        },
+        [](binBlock & total, const binBlock & block)
+        {
+            for (int i = 0; i < NUM_SCORE_BINS; i++)
+                total.mBins[i] += block.mBins[i];
+        });
+
+    for (int i = 0; i < NUM_SCORE_BINS; i++)
+        distribution.mBins[i] = bins.mBins[i];
+}
@@ -0,0 +1,79 @@
+//  this file contains the block reductions that per-generation distributions are worked out with, across threads or not
+
+#ifndef REDUCE_H_INCLUDED
+#define REDUCE_H_INCLUDED
+
+#include "Pool.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+/*
+A reduction cuts the population into blocks of REDUCE_BLOCK_SIZE clocks, however many threads there are, works out each
+block's result on its own, and then combines the blocks' results one after another in block order. Floating point sums
+come out differently in a different order, so fixing the blocks and the order makes the result the same bit for bit on
+any number of threads.
+*/
+
+//  clocks in each block of a reduction
+const long REDUCE_BLOCK_SIZE = 4096;
+
+//  reduces [0, size) block by block: 'map(begin, end, result)' fills a block's result (starting from 'initial'), and
+//  'combine(total, result)' folds each block into the total in block order; blocks run on the pool if there's one
+template <class T, class Map, class Combine>
+T reduceBlocks(workPool * pool, long size, const T & initial, Map map, Combine combine)
+{
+    long numBlocks = (size + REDUCE_BLOCK_SIZE - 1) / REDUCE_BLOCK_SIZE;
+    vector<T> blocks(numBlocks, initial);
+    bool isParallel = pool != NULL && pool->size() > 1 && numBlocks > 1;
+
+    for (long i = 0; i < numBlocks; i++)
+    {
+        long begin = i * REDUCE_BLOCK_SIZE;
+        long end = min(size, begin + REDUCE_BLOCK_SIZE);
+        T * block = &blocks[i];
+
+        if (isParallel)
+            pool->submit([&map, begin, end, block]() {map(begin, end, *block);});
+        else
+            map(begin, end, *block);
+    }
+
+    if (isParallel)
+        pool->wait();
+
+    T total = initial;
+    for (long i = 0; i < numBlocks; i++)
+        combine(total, blocks[i]);
+
+    return total;
+}
+
+//  the score distribution's columns: the best clock, the quantiles, then the histogram
+const int NUM_SCORE_QUANTILES = 5;
+const int NUM_SCORE_BINS = 10;
+const int NUM_DISTRIBUTION_COLUMNS = 1 + NUM_SCORE_QUANTILES + NUM_SCORE_BINS;
+const char * const DISTRIBUTION_NAMES[NUM_DISTRIBUTION_COLUMNS] = {"best_clock", "score_min", "score_q1", "score_median", "score_q3",
+"score_max", "score_bin_0", "score_bin_1", "score_bin_2", "score_bin_3", "score_bin_4", "score_bin_5", "score_bin_6", "score_bin_7",
+"score_bin_8", "score_bin_9"};
+
+//  how the scores of a generation are spread out
+struct scoreDistribution
+{
+    //  index of the clock with the best score (the first, if several share it), or -1 if none has been scored
+    double mBestClock;
+
+    //  lowest, lower quartile, median, upper quartile and highest score
+    double mQuantiles[NUM_SCORE_QUANTILES];
+
+    //  number of clocks in each tenth of the range from 0 to the highest score
+    double mBins[NUM_SCORE_BINS];
+};
+
+//  works out the distribution of the scores of clocks 0 to size - 1, where 'getScore(index, score)' gives a clock's
+//  score, or returns false for a clock that doesn't have one
+void calcScoreDistribution(workPool * pool, long size, function<bool(long, double &)> getScore, scoreDistribution & distribution);
+
+#endif // REDUCE_H_INCLUDED
@@ -0,0 +1,370 @@
+//  this file defines the reference evaluator (see ReferenceClock.h before changing anything here)
+#include "ReferenceClock.h"
+
+#include <cmath>
+
+//  scoreDiff() as it was, kept here so changing the one in Clock.cpp can't change the reference
+static double referenceScoreDiff(double num1, double num2)
+{
+    double difference = num1 - num2;
+
+    if (difference < 0)
+        difference = -difference;
+
+    return (difference < MIN_SCORE) ? MAX_SCORE : 1 / difference;
+}
+
+referenceClock::referenceClock(int genomeSize, const pieceGene * genome, double scoreMultiplier)
+{
+    const referencePiece EMPTY_PIECE = {PTYPE_NULL, 0, 0, 0, false, false, false};
+
+    mGenomeSize = genomeSize;
+    mScoreMultiplier = scoreMultiplier;
+    mPieces.assign(genomeSize * genomeSize, EMPTY_PIECE);
+    for (int i = 0; i < genomeSize * genomeSize; i++)
+    {
+        mPieces[i].mPieceType = genome[i].mPieceType;
+        mPieces[i].mNumTeeth = genome[i].mNumTeeth;
+        mPieces[i].mPendulumLength = genome[i].mPendulumLength;
+    }
+
+    mBestPendulum = EMPTY_PIECE;
+    for (int i = 0; i < 3; i++)
+        mGear[i] = EMPTY_PIECE;
+
+    mSurvivalScore = 0;
+    mIsScored = 0;
+    mNumHands = 0;
+    mNotNullPieces = 0;
+}
+
+clockSummary referenceClock::getSummary()
+{
+    clockSummary summary;
+
+    summary.mSurvivalScore = mSurvivalScore;
+    summary.mPendInterval = mBestPendulum.mPieceInterval;
+    for (int i = 0; i < 3; i++)
+    {
+        summary.mGearInterval[i] = mGear[i].mPieceInterval;
+        summary.mGearHand[i] = mGear[i].mIsAttToHand;
+    }
+    summary.mNumHands = mNumHands;
+    summary.mNotNullPieces = mNotNullPieces;
+    summary.mIsScored = mIsScored;
+
+    return summary;
+}
+
+void referenceClock::setSummary(const clockSummary & summary)
+{
+    mSurvivalScore = summary.mSurvivalScore;
+    mBestPendulum.mPieceInterval = summary.mPendInterval;
+    for (int i = 0; i < 3; i++)
+    {
+        mGear[i].mPieceInterval = summary.mGearInterval[i];
+        mGear[i].mIsAttToHand = summary.mGearHand[i] != 0;
+    }
+    mNumHands = summary.mNumHands;
+    mNotNullPieces = summary.mNotNullPieces;
+    mIsScored = summary.mIsScored;
+}
+
+double referenceClock::calcSurvivalScore()
+{
+    int i, j, k;
+    int connectedPieces = 0;
+    int notNullPieces = 0;
+    bool pendConflict = false;
+    bool bestPendOnTrain = false;
+    const double SCORE_MULTIPLIER = mScoreMultiplier;
+    const int TIMES_TO_SCAN = 3;
+    bool isBroken = false;
+    double returnScore = 0.;
+    double pendScore = 0.;
+    double totalGearScore = 0.;
+    double gearScore[] = {0, 0, 0};
+    bool isTrainPowered = false;
+
+    mIsScored = 1;
+
+    for (i = 0; i < mGenomeSize; i++)
+        for (j = 0; j < mGenomeSize; j++)
+            piece(i, j).mPieceInterval = 0;
+
+    //  connections are checked from the first piece found, row by row
+    for (i = 0; i < mGenomeSize && !isBroken; i++)
+    {
+        for (j = 0; j < mGenomeSize; j++)
+        {
+            if (piece(i, j).mPieceType != PTYPE_NULL)
+            {
+                checkPieceConn(i, j);
+                isBroken = true;
+                break;
+            }
+        }
+    }
+
+    for (k = 1; k <= TIMES_TO_SCAN; k++)
+    {
+        isBroken = false;
+
+        for (i = 0; i < mGenomeSize && !isBroken; i++)
+        {
+            for (j = 0; j < mGenomeSize; j++)
+            {
+                if (k == 1)
+                {
+                    notNullPieces += (piece(i, j).mPieceType != PTYPE_NULL);
+                    connectedPieces += (piece(i, j).mIsConnected && piece(i, j).mPieceType != PTYPE_NULL);
+                }
+                else if (k == 2)
+                {
+                    if (piece(i, j).mPieceType == PTYPE_PENDULUM)
+                    {
+                        double currentPendScore = checkPendulum(i, j);
+
+                        pendConflict += (bestPendOnTrain && isPendOnTrain(i, j));
+
+                        if (!bestPendOnTrain)
+                        {
+                            if (currentPendScore > pendScore)
+                            {
+                                pendScore = currentPendScore;
+                                mBestPendulum = piece(i, j);
+                                bestPendOnTrain = isPendOnTrain(i, j);
+                            }
+                        }
+                    }
+                }
+                else if (k == 3)
+                {
+                    //  only the first gear an escapement drives starts a train
+                    if (piece(i, j).mPieceType == PTYPE_GEAR && piece(i, j).mPieceInterval != 0)
+                    {
+                        double attPendInterval = piece(i, j).mPieceInterval / (double)piece(i, j).mNumTeeth;
+                        calcGearInfo(i, j, attPendInterval);
+
+                        isBroken = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        mNotNullPieces = notNullPieces;
+
+        //  a broken clock keeps the rest of its last summary
+        if (notNullPieces != connectedPieces)
+            return 0;
+    }
+
+    if (mGearTrain.size() > 0)
+    {
+        for (i = 0; i < (signed int)mGearTrain.size(); i++)
+        {
+            if (pendConflict)
+            {
+                totalGearScore = 0;
+                gearScore[INDEX_SEC] = 0;
+                gearScore[INDEX_MIN] = 0;
+                gearScore[INDEX_HR] = 0;
+                mGearTrain.clear();
+
+                break;
+            }
+            else
+            {
+                isTrainPowered += mGearTrain[i].mIsPowered;
+
+                for (j = 0; j < 3; j++)
+                {
+                    double currentGearScore = referenceScoreDiff(mGearTrain[i].mPieceInterval, TIME_INTERVAL[j]);
+
+                    if (mGearTrain[i].mIsAttToHand)
+                        currentGearScore *= SCORE_MULTIPLIER;
+
+                    //  the time gears compared against are the ones kept so far, starting from the last evaluation's
+                    if (currentGearScore > gearScore[j] && mGear[INDEX_SEC].mPieceInterval != mGearTrain[i].mPieceInterval
+                        && mGear[INDEX_MIN].mPieceInterval != mGearTrain[i].mPieceInterval && mGear[INDEX_HR].mPieceInterval != mGearTrain[i].mPieceInterval)
+                    {
+                        gearScore[j] = currentGearScore;
+                        mGear[j] = mGearTrain[i];
+                    }
+                }
+            }
+        }
+    }
+
+    mNumHands = mGear[INDEX_SEC].mIsAttToHand + mGear[INDEX_MIN].mIsAttToHand + mGear[INDEX_HR].mIsAttToHand;
+
+    totalGearScore = gearScore[INDEX_SEC] + gearScore[INDEX_MIN] + gearScore[INDEX_HR];
+
+    if (isTrainPowered)
+        totalGearScore *= SCORE_MULTIPLIER;
+
+    if (mGearTrain.size() > 0)
+        totalGearScore *= SCORE_MULTIPLIER;
+
+    returnScore += totalGearScore;
+    returnScore += pendScore;
+    returnScore += (mGearTrain.size() / SCORE_MULTIPLIER);
+    returnScore -= (notNullPieces / SCORE_MULTIPLIER);
+
+    if (returnScore < 0)
+        returnScore = 0;
+
+    mSurvivalScore = returnScore;
+    mGearTrain.clear();
+
+    return returnScore;
+}
+
+void referenceClock::checkPieceConn(int x, int y)
+{
+    piece(x, y).mIsConnected = true;
+
+    for (int i = -1; i <= 1; i++)
+        for (int j = -1; j <= 1; j++)
+        {
+            if ((i == 0) != (j == 0))
+                if (isInside(x + i, y + j))
+                    if (piece(x + i, y + j).mPieceType != PTYPE_NULL && piece(x + i, y + j).mIsConnected == false)
+                        checkPieceConn(x + i, y + j);
+        }
+}
+
+double referenceClock::checkPendulum(int x, int y)
+{
+    int numConnections = 0;
+    const double gravStrength = 9.81;
+    const double pi = 3.14;
+
+    for (int i = -1; i <= 1; i++)
+        for (int j = -1; j <= 1; j++)
+        {
+            if ((i == 0) != (j == 0))
+                if (isInside(x + i, y + j))
+                {
+                    if (piece(x + i, y + j).mPieceType != PTYPE_NULL)
+                        numConnections++;
+                }
+        }
+
+    if (numConnections != 1)
+        return 0;
+
+    double pendPeriod = 2 * pi * sqrt(piece(x, y).mPendulumLength / gravStrength);
+    double returnScore = referenceScoreDiff(pendPeriod, 1);
+
+    piece(x, y).mPieceInterval = pendPeriod;
+    return returnScore;
+}
+
+bool referenceClock::checkEscapement(int x, int y)
+{
+    int workingPends = 0;
+    int gears = 0;
+    int nullPieces = 0;
+    int attGearX = 0;
+    int attGearY = 0;
+    int attPendX = 0;
+    int attPendY = 0;
+
+    for (int i = -1; i <= 1; i++)
+        for (int j = -1; j <= 1; j++)
+        {
+            if ((i == 0) != (j == 0))
+            {
+                if (isInside(x + i, y + j))
+                {
+                    nullPieces += (piece(x + i, y + j).mPieceType == PTYPE_NULL);
+
+                    if (piece(x + i, y + j).mPieceType == PTYPE_PENDULUM && piece(x + i, y + j).mPieceInterval != 0)
+                    {
+                        workingPends++;
+                        attPendX = x + i;
+                        attPendY = y + j;
+                    }
+
+                    if (piece(x + i, y + j).mPieceType == PTYPE_GEAR)
+                    {
+                        gears++;
+                        attGearX = x + i;
+                        attGearY = y + j;
+                    }
+                }
+            }
+        }
+
+    if (workingPends == 1 && gears == 1 && nullPieces == 2)
+    {
+        double attPendInterval = piece(attPendX, attPendY).mPieceInterval;
+        int attGearNumTeeth = piece(attGearX, attGearY).mNumTeeth;
+
+        piece(attGearX, attGearY).mPieceInterval = attGearNumTeeth * attPendInterval;
+
+        return true;
+    }
+
+    return false;
+}
+
+void referenceClock::calcGearInfo(int x, int y, double attPendInterval)
+{
+    bool isGearPowered = false;
+    bool isAttToHand = false;
+    int i, j;
+
+    double gearInterval = (double)piece(x, y).mNumTeeth * attPendInterval;
+
+    for (i = -1; i <= 1; i++)
+        for (j = -1; j <= 1; j++)
+            if ((i == 0) != (j == 0))
+                if (isInside(x + i, y + j))
+                {
+                    if (piece(x + i, y + j).mPieceType == PTYPE_MAINSPRING && !isGearPowered)
+                        isGearPowered = checkMainspringOrHand(x + i, y + j);
+                    else if (piece(x + i, y + j).mPieceType == PTYPE_HAND && !isAttToHand)
+                        isAttToHand = checkMainspringOrHand(x + i, y + j);
+                }
+
+    piece(x, y).mIsPowered = isGearPowered;
+    piece(x, y).mIsAttToHand = isAttToHand;
+    piece(x, y).mPieceInterval = gearInterval;
+
+    for (i = -1; i <= 1; i++)
+        for (j = -1; j <= 1; j++)
+            if ((i == 0) != (j == 0))
+                if (isInside(x + i, y + j))
+                    if (piece(x + i, y + j).mPieceType == PTYPE_GEAR && piece(x + i, y + j).mPieceInterval == 0)
+                        calcGearInfo(x + i, y + j, attPendInterval);
+
+    mGearTrain.push_back(piece(x, y));
+}
+
+bool referenceClock::checkMainspringOrHand(int x, int y)
+{
+    int attPieceCount = 0;
+
+    for (int i = -1; i <= 1; i++)
+        for (int j = -1; j <= 1; j++)
+            if ((i == 0) != (j == 0))
+                if (isInside(x + i, y + j))
+                    attPieceCount += (piece(x + i, y + j).mPieceType != PTYPE_NULL);
+
+    return (attPieceCount == 1);
+}
+
+bool referenceClock::isPendOnTrain(int x, int y)
+{
+    for (int i = -1; i <= 1; i++)
+        for (int j = -1; j <= 1; j++)
+            if ((i == 0) != (j == 0))
+                if (isInside(x + i, y + j))
+                    if (piece(x + i, y + j).mPieceType == PTYPE_ESCAPEMENT)
+                        if (checkEscapement(x + i, y + j))
+                            return true;
+    return false;
+}
@@ -0,0 +1,81 @@
+//  this file contains the reference evaluator, a frozen copy of bioClock::calcSurvivalScore() that faster ones are checked against
+
+#ifndef REFERENCECLOCK_H_INCLUDED
+#define REFERENCECLOCK_H_INCLUDED
+
+#include "Clock.h"
+
+#include <vector>
+
+using namespace std;
+
+/*
+DON'T CHANGE THIS FILE to follow changes to bioClock. It's the definition of what a clock scores, quirks included: the
+gear train is started from the first gear (row by row) that an escapement drives, the 'isBroken' break only leaves the
+inner loop, pendulum conflicts are counted with bool arithmetic, a clock found broken keeps its old summary apart from
+its piece count, the time gears of the last evaluation decide which gears can take a slot in this one, and pieces stay
+marked as connected from one evaluation to the next.
+
+A clock's evaluation depends on its genes, those connection marks and the summary its last evaluation left, so that's
+all the reference clock is made from and all it gives back. scorecheck runs genomes through both evaluators and
+compares everything, so any faster bioClock::calcSurvivalScore() has to give the same results bit for bit.
+*/
+
+class referenceClock
+{
+private:
+
+    //  a piece as the evaluator sees it: its genes and what evaluating works out about it
+    struct referencePiece
+    {
+        int mPieceType;
+        int mNumTeeth;
+        double mPendulumLength;
+        double mPieceInterval;
+        bool mIsPowered;
+        bool mIsAttToHand;
+        bool mIsConnected;
+    };
+
+    int mGenomeSize;
+    vector<referencePiece> mPieces;
+    vector<referencePiece> mGearTrain;
+    referencePiece mBestPendulum;
+    referencePiece mGear[3];
+
+    double mSurvivalScore;
+    int mIsScored;
+    int mNumHands;
+    int mNotNullPieces;
+
+    //  the selective pressure magnitude the clock is scored with
+    double mScoreMultiplier;
+
+    referencePiece & piece(int x, int y) {return mPieces[x * mGenomeSize + y];};
+    bool isInside(int x, int y) {return x < mGenomeSize && x >= 0 && y < mGenomeSize && y >= 0;};
+
+    void checkPieceConn(int x, int y);
+    double checkPendulum(int x, int y);
+    bool isPendOnTrain(int x, int y);
+    bool checkEscapement(int x, int y);
+    void calcGearInfo(int x, int y, double attPendInterval);
+    bool checkMainspringOrHand(int x, int y);
+
+public:
+
+    //  makes a clock that has never been scored from its genes (genomeSize * genomeSize of them, row by row)
+    referenceClock(int genomeSize, const pieceGene * genome, double scoreMultiplier);
+
+    //  whether a piece is marked as connected to the rest of the clock
+    bool isConnected(int x, int y) {return piece(x, y).mIsConnected;};
+    void setConnected(int x, int y, bool isConnected) {piece(x, y).mIsConnected = isConnected;};
+
+    //  what the last evaluation left, in the form bioClock keeps it
+    clockSummary getSummary();
+    void setSummary(const clockSummary & summary);
+
+    //  evaluates the clock, exactly as bioClock::calcSurvivalScore() did when this was written
+    double calcSurvivalScore();
+};
+
+#endif // REFERENCECLOCK_H_INCLUDED
@@ -0,0 +1,198 @@
+//  this file defines the replay scenarios
+#include "Replay.h"
+#include "Evolve.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+using namespace std;
+
+//  every scenario is seeded the same way; changing one changes its checksum, so old result files stop matching
+const replayScenario REPLAY_SCENARIOS[] =
+{
+    {"tournament", "pop=1000 gens=40 seed=20090225"},
+    {"roulette", "pop=1000 gens=40 selmode=1 seed=20090225"},
+    {"rank", "pop=1000 gens=40 selmode=2 seed=20090225"},
+    {"bigtournament", "pop=1000 gens=20 tsize=7 selmag=100 seed=20090225"},
+    {"biggenome", "pop=250 gens=40 genome=20 seed=20090225"},
+    {"store", "pop=1000 gens=40 store=1 seed=20090225"},
+    {"sharedtiles", "pop=250 gens=40 genome=20 store=2 seed=20090225"},
+    {"highpressure", "pop=500 gens=240 selmag=1000 seed=20090225"}
+};
+
+const int NUM_REPLAY_SCENARIOS = sizeof(REPLAY_SCENARIOS) / sizeof(REPLAY_SCENARIOS[0]);
+
+//  what one scenario gave
+struct replayResult
+{
+    double mSeconds;
+    int mGensRun;
+    uint64_t mChecksum;
+
+    //  what the running statistics got wrong, checked against a recount at the end (empty when they're right)
+    string mStatsError;
+};
+
+//  runs a scenario once
+static replayResult runScenario(varData settings)
+{
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    seedSimRand((unsigned long)settings.mSeed, 1);
+    world simulation(settings);
+    simulation.initClocks();
+    simulation.mateClocks();
+
+    replayResult result;
+    result.mSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    result.mGensRun = simulation.getGensRun();
+    result.mChecksum = simulation.calcChecksum();
+    result.mStatsError = simulation.checkStats();
+
+    return result;
+}
+
+//  reads a results file written by --out, by scenario name
+static bool readResults(string path, map<string, replayResult> & results)
+{
+    ifstream in(path.c_str());
+    if (!in)
+        return false;
+
+    string line;
+    getline(in, line);
+    while (getline(in, line))
+    {
+        char name[64];
+        replayResult result;
+        unsigned long long checksum;
+
+        if (sscanf(line.c_str(), "%63[^,],%lf,%d,%llx", name, &result.mSeconds, &result.mGensRun, &checksum) == 4)
+        {
+            result.mChecksum = checksum;
+            results[name] = result;
+        }
+    }
+
+    return true;
+}
+
+int runReplay(int argc, char * argv[])
+{
+    string only, outputPath, comparePath;
+    int numReps = 1;
+
+    for (int i = 0; i < argc; i++)
+    {
+        string argument = argv[i];
+        if (argument.compare(0, 7, "--only=") == 0)
+            only = "," + argument.substr(7) + ",";
+        else if (argument.compare(0, 7, "--reps=") == 0)
+            numReps = max(1, atoi(argument.c_str() + 7));
+        else if (argument.compare(0, 6, "--out=") == 0)
+            outputPath = argument.substr(6);
+        else if (argument.compare(0, 10, "--compare=") == 0)
+            comparePath = argument.substr(10);
+        else
+        {
+            cerr << "usage: watchingevolution replay [--only=name,name] [--reps=N] [--out=file.csv] [--compare=file.csv]" << endl;
+            return 1;
+        }
+    }
+
+    map<string, replayResult> earlier;
+    if (!comparePath.empty() && !readResults(comparePath, earlier))
+    {
+        cerr << "Can't read replay results '" << comparePath << "'" << endl;
+        return 1;
+    }
+
+    stringstream csv;
+    csv << "scenario,seconds,generations,checksum\n";
+    bool isDifferent = false;
+
+    printf("%-14s %10s %6s %18s", "scenario", "seconds", "gens", "checksum");
+    if (!comparePath.empty())
+        printf(" %10s %8s", "before", "speedup");
+    printf("\n");
+
+    for (int i = 0; i < NUM_REPLAY_SCENARIOS; i++)
+    {
+        string name = REPLAY_SCENARIOS[i].mName;
+        if (!only.empty() && only.find("," + name + ",") == string::npos)
+            continue;
+
+        varData settings;
+        stringstream words(REPLAY_SCENARIOS[i].mSettings);
+        vector<string> settingWords;
+        string word;
+        while (words >> word)
+            settingWords.push_back(word);
+
+        string error = applySettings(settings, settingWords);
+        if (!error.empty())
+        {
+            cerr << "Replay scenario '" << name << "': " << error << endl;
+            return 1;
+        }
+        settings.mSimTimes = 1;
+        settings.mShowInterval = 0;
+
+        //  the fastest run is the one least disturbed by whatever else the machine was doing
+        replayResult best = runScenario(settings);
+        if (!best.mStatsError.empty())
+        {
+            cerr << "Replay scenario '" << name << "' ended with statistics that don't match a recount: " << best.mStatsError << endl;
+            return 1;
+        }
+        for (int r = 1; r < numReps; r++)
+        {
+            replayResult result = runScenario(settings);
+            if (result.mChecksum != best.mChecksum)
+            {
+                cerr << "Replay scenario '" << name << "' didn't repeat its own run, so it isn't deterministic" << endl;
+                return 1;
+            }
+            best.mSeconds = min(best.mSeconds, result.mSeconds);
+        }
+
+        printf("%-14s %10.3f %6d   %016llx", name.c_str(), best.mSeconds, best.mGensRun, (unsigned long long)best.mChecksum);
+        if (earlier.count(name))
+        {
+            const replayResult & before = earlier[name];
+            printf(" %10.3f %7.2fx", before.mSeconds, before.mSeconds / best.mSeconds);
+            if (before.mChecksum != best.mChecksum)
+            {
+                printf("  checksum differs (was %016llx)", (unsigned long long)before.mChecksum);
+                isDifferent = true;
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+
+        char row[128];
+        snprintf(row, sizeof(row), "%s,%.6f,%d,%016llx\n", name.c_str(), best.mSeconds, best.mGensRun, (unsigned long long)best.mChecksum);
+        csv << row;
+    }
+
+    if (!outputPath.empty())
+    {
+        ofstream out(outputPath.c_str());
+        out << csv.str();
+        if (!out)
+        {
+            cerr << "Can't write replay results to '" << outputPath << "'" << endl;
+            return 1;
+        }
+    }
+
+    if (isDifferent)
+    {
+        cerr << "Some scenarios didn't do the same work as before, so their times can't be compared" << endl;
+        return 1;
+    }
+
+    return 0;
+}
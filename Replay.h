@@ -0,0 +1,33 @@
+//  this file contains the replay scenarios, seeded runs that do the same work every time so builds can be timed against each other
+
+#ifndef REPLAY_H_INCLUDED
+#define REPLAY_H_INCLUDED
+
+using namespace std;
+
+/*
+USAGE: watchingevolution replay [--only=name,name] [--reps=N] [--out=file.csv] [--compare=file.csv]
+
+Each scenario is a fixed set of settings with a fixed seed, run without output files or console. Its wall time is the
+fastest of 'reps' runs (1 by default), and its checksum covers the genes and scores of the final population, so two
+builds with the same checksum did exactly the same work and their times can be compared directly. At the end of each
+run the running statistics are checked against a recount of every clock, and a scenario whose totals are off fails.
+
+--out writes the results as a CSV file, and --compare reads one written earlier (by another build, say) and shows the
+speedup of each scenario, failing if a checksum differs, since then the builds didn't run the same simulation.
+*/
+
+//  a scenario's name and settings, as 'name=value' words
+struct replayScenario
+{
+    const char * mName;
+    const char * mSettings;
+};
+
+extern const replayScenario REPLAY_SCENARIOS[];
+extern const int NUM_REPLAY_SCENARIOS;
+
+//  runs the scenarios with the arguments after 'replay', returning the exit code
+int runReplay(int argc, char * argv[]);
+
+#endif // REPLAY_H_INCLUDED
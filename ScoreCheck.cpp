@@ -0,0 +1,216 @@
+//  this file is the differential harness, which checks bioClock::calcSurvivalScore() against the reference evaluator
+#include "Clock.h"
+#include "ReferenceClock.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+using namespace std;
+
+/*
+USAGE: scorecheck [--seed=S] [--batches=N] [--genome=N]
+
+Each batch is seeded with S plus its number, and picks a genome size (unless one is given), a selective pressure and a
+mutation rate. It makes a population of random clocks and breeds it with tournaments, scoring every contestant and
+every child with both evaluators and comparing the score, the summary and which pieces are marked as connected. The
+clocks are scored again and again as they're drawn, so what one evaluation leaves for the next is checked as well as
+the genomes themselves, random at first and evolved later on.
+
+A batch stops at its first difference, printing the clock and both results. 'scorecheck --seed=<its seed> --batches=1'
+runs that batch again on its own. The exit code is 1 if anything differed.
+*/
+
+//  the definition the evaluator reads the selective pressure from (the simulation's is in Evolve.cpp)
+thread_local int PRESSURE_MAGNITUDE = 0;
+
+//  clocks in each batch's population, and tournaments run on it
+const int CHECK_POPULATION = 24;
+const int CHECK_TOURNAMENTS = 400;
+
+//  the choices a batch picks from when it isn't told
+const int PRESSURES[] = {1, 2, 10, 100, 1000};
+const double MUTATION_RATES[] = {0.5, 1, 5, 20};
+
+//  whether two doubles are the same bit for bit (so a NaN matches itself, and 0 doesn't match -0)
+static bool isSame(double a, double b)
+{
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+static bool isSameSummary(const clockSummary & a, const clockSummary & b)
+{
+    bool isSame = ::isSame(a.mSurvivalScore, b.mSurvivalScore) && ::isSame(a.mPendInterval, b.mPendInterval)
+        && a.mNumHands == b.mNumHands && a.mNotNullPieces == b.mNotNullPieces && a.mIsScored == b.mIsScored;
+
+    for (int i = 0; i < 3; i++)
+        isSame = isSame && ::isSame(a.mGearInterval[i], b.mGearInterval[i]) && a.mGearHand[i] == b.mGearHand[i];
+
+    return isSame;
+}
+
+static void printSummary(const char * name, double score, const clockSummary & summary)
+{
+    printf("  %-9s score %.17g, pendulum %.17g, gears %.17g %.17g %.17g, hands %d%d%d (%d), pieces %d, scored %d\n", name, score,
+        summary.mPendInterval, summary.mGearInterval[0], summary.mGearInterval[1], summary.mGearInterval[2], summary.mGearHand[0],
+        summary.mGearHand[1], summary.mGearHand[2], summary.mNumHands, summary.mNotNullPieces, summary.mIsScored);
+}
+
+//  makes the reference clock that matches a clock as it is now
+static referenceClock makeReference(bioClock & clock, int genomeSize, vector<pieceGene> & genome)
+{
+    clock.getGenome(&genome[0]);
+    referenceClock reference(genomeSize, &genome[0], PRESSURE_MAGNITUDE);
+
+    reference.setSummary(clock.getSummary());
+    for (int x = 0; x < genomeSize; x++)
+        for (int y = 0; y < genomeSize; y++)
+            reference.setConnected(x, y, clock.isConnected(x, y));
+
+    return reference;
+}
+
+//  scores a clock with both evaluators, printing the difference if there is one
+static bool checkClock(bioClock & clock, referenceClock & reference, int genomeSize, unsigned long seed, int tournament)
+{
+    //  the state both start from, for the report
+    clockSummary before = clock.getSummary();
+
+    double score = clock.calcSurvivalScore();
+    double referenceScore = reference.calcSurvivalScore();
+    clockSummary summary = clock.getSummary();
+    clockSummary referenceSummary = reference.getSummary();
+
+    int connectionDiffs = 0;
+    for (int x = 0; x < genomeSize; x++)
+        for (int y = 0; y < genomeSize; y++)
+            connectionDiffs += (clock.isConnected(x, y) != reference.isConnected(x, y));
+
+    if (isSame(score, referenceScore) && isSameSummary(summary, referenceSummary) && connectionDiffs == 0)
+        return true;
+
+    const char PIECE_LETTERS[] = {' ', 'E', 'M', 'G', 'H', 'P'};
+
+    printf("Seed %lu, tournament %d: genome %d, pressure %d\n", seed, tournament, genomeSize, PRESSURE_MAGNITUDE);
+    for (int x = 0; x < genomeSize; x++)
+    {
+        printf("  |");
+        for (int y = 0; y < genomeSize; y++)
+            printf("%c", PIECE_LETTERS[clock.getClockPiece(x, y).getPieceType()]);
+        printf("|\n");
+    }
+    printSummary("before", before.mSurvivalScore, before);
+    printSummary("bioClock", score, summary);
+    printSummary("reference", referenceScore, referenceSummary);
+    if (connectionDiffs > 0)
+        printf("  %d pieces are marked connected by one evaluator and not the other\n", connectionDiffs);
+
+    return false;
+}
+
+//  runs one batch, returning the number of evaluations checked, or -1 if one differed
+static long runBatch(unsigned long seed, int fixedGenomeSize)
+{
+    MTRand & randGen = simRand();
+    randGen.seed((MTRand::uint32)seed);
+
+    int genomeSize = (fixedGenomeSize > 0) ? fixedGenomeSize : 1 + randGen.randInt(19);
+    PRESSURE_MAGNITUDE = PRESSURES[randGen.randInt(sizeof(PRESSURES) / sizeof(PRESSURES[0]) - 1)];
+    double mutationRate = MUTATION_RATES[randGen.randInt(sizeof(MUTATION_RATES) / sizeof(MUTATION_RATES[0]) - 1)];
+
+    vector<pieceGene> genome(genomeSize * genomeSize);
+    vector<bioClock> population;
+    vector<referenceClock> references;
+    vector<double> scores;
+    long numChecked = 0;
+
+    for (int i = 0; i < CHECK_POPULATION; i++)
+    {
+        population.push_back(bioClock(genomeSize));
+        population.back().setMutationRate(mutationRate);
+        references.push_back(makeReference(population.back(), genomeSize, genome));
+
+        if (!checkClock(population[i], references[i], genomeSize, seed, 0))
+            return -1;
+        scores.push_back(population[i].getSurvivalScore());
+        numChecked++;
+    }
+
+    for (int t = 1; t <= CHECK_TOURNAMENTS; t++)
+    {
+        //  three contestants, scored again as they're drawn; the best two breed over the worst
+        int contestants[3];
+        for (int i = 0; i < 3; i++)
+        {
+            contestants[i] = randGen.randInt(CHECK_POPULATION - 1);
+            if (!checkClock(population[contestants[i]], references[contestants[i]], genomeSize, seed, t))
+                return -1;
+            scores[contestants[i]] = population[contestants[i]].getSurvivalScore();
+            numChecked++;
+        }
+
+        sort(contestants, contestants + 3, [&scores](int a, int b) {return scores[a] > scores[b];});
+        int child = contestants[2];
+
+        population[child] = bioClock(population[contestants[0]], population[contestants[1]]);
+        references[child] = makeReference(population[child], genomeSize, genome);
+
+        if (!checkClock(population[child], references[child], genomeSize, seed, t))
+            return -1;
+        scores[child] = population[child].getSurvivalScore();
+        numChecked++;
+    }
+
+    return numChecked;
+}
+
+int main(int argc, char * argv[])
+{
+    unsigned long seed = 1;
+    long numBatches = 1000;
+    int genomeSize = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string argument = argv[i];
+        if (argument.compare(0, 7, "--seed=") == 0)
+            seed = strtoul(argument.c_str() + 7, NULL, 10);
+        else if (argument.compare(0, 10, "--batches=") == 0)
+            numBatches = atol(argument.c_str() + 10);
+        else if (argument.compare(0, 9, "--genome=") == 0)
+            genomeSize = atoi(argument.c_str() + 9);
+        else
+        {
+            cerr << "usage: scorecheck [--seed=S] [--batches=N] [--genome=N]" << endl;
+            return 1;
+        }
+    }
+
+    if (numBatches < 1 || genomeSize < 0 || genomeSize > 50)
+    {
+        cerr << "scorecheck needs at least one batch, and a genome size from 1 to 50" << endl;
+        return 1;
+    }
+
+    clock_t startTime = clock();
+    long numChecked = 0;
+    long numFailed = 0;
+
+    for (long b = 0; b < numBatches; b++)
+    {
+        long batchChecked = runBatch(seed + b, genomeSize);
+        if (batchChecked < 0)
+            numFailed++;
+        else
+            numChecked += batchChecked;
+    }
+
+    double seconds = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+    printf("%ld evaluations matched in %ld batches (seeds %lu to %lu), %ld batches differed, in %.1f seconds\n", numChecked,
+        numBatches - numFailed, seed, seed + numBatches - 1, numFailed, seconds);
+
+    return (numFailed > 0) ? 1 : 0;
+}
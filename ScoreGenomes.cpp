@@ -0,0 +1,197 @@
+//  this file is the genome scorer, a tool that scores genomes from a file without evolving anything
+#include "Clock.h"
+#include "GenomeFile.h"
+#include "Pool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace std;
+
+/*
+USAGE: scoregenomes <file> [--out=file.csv] [--selmag=N] [--threads=N] [--genome=N] [--teeth=N] [--length=L]
+
+Reads a binary genome file (tracereplay --genomes=<file> writes one) or text grids (a simN_genomes.txt, or what
+tracereplay prints) and scores every genome the way a newborn clock is scored, writing one line per genome:
+
+    genome,survival_score,pendulum_interval,sec_gear_interval,min_gear_interval,hr_gear_interval,hands,pieces
+
+in the order the genomes were read. --selmag is the selective pressure the scores are worked out with (10, as in the
+simulation, by default), and --threads is the number of threads scoring (one per core by default). --genome, --teeth
+and --length only apply to text: the genome size if it isn't the length of the first row, and the teeth of every gear
+and length of every pendulum, since the letters don't say (60 teeth, and a pendulum that swings once a second).
+
+Genomes are read a chunk at a time while the last chunk is scored, and the summary at the end goes to stderr.
+*/
+
+//  the definition the evaluator reads the selective pressure from (the simulation's is in Evolve.cpp)
+thread_local int PRESSURE_MAGNITUDE = 0;
+
+//  pieces read at a time (whole genomes, so a chunk is never less than one), and the number of parts each chunk is split
+//  into per thread so a slow part doesn't hold up the rest
+const long CHUNK_CELLS = 1 << 20;
+const int PARTS_PER_THREAD = 4;
+
+//  longest line one genome's scores can make
+const int MAX_LINE = 256;
+
+//  a chunk of genomes and the lines they score to, in parts
+struct scoreChunk
+{
+    vector<pieceGene> mGenomes;
+    long mFirstIndex;
+    long mNumGenomes;
+    vector<string> mLines;
+};
+
+//  scores genomes 'first' to 'last' of a chunk, appending their lines to 'lines'
+static void scoreGenomes(const scoreChunk & chunk, long first, long last, int genomeSize, int pressure, string & lines)
+{
+    int numCells = genomeSize * genomeSize;
+    char line[MAX_LINE];
+
+    //  each genome goes into the same clock over whatever was there
+    PRESSURE_MAGNITUDE = pressure;
+    bioClock clock(genomeSize, &chunk.mGenomes[first * numCells]);
+
+    lines.clear();
+    lines.reserve((last - first) * 64);
+
+    for (long i = first; i < last; i++)
+    {
+        clock.renew(&chunk.mGenomes[i * numCells]);
+
+        double score = clock.calcSurvivalScore();
+        clockSummary summary = clock.getSummary();
+
+        int length = snprintf(line, sizeof(line), "%ld,%.17g,%.17g,%.17g,%.17g,%.17g,%d,%d\n", chunk.mFirstIndex + i, score,
+            summary.mPendInterval, summary.mGearInterval[INDEX_SEC], summary.mGearInterval[INDEX_MIN], summary.mGearInterval[INDEX_HR],
+            summary.mNumHands, summary.mNotNullPieces);
+        lines.append(line, length);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    string inputPath, outputPath;
+    int pressure = 10;
+    int numThreads = 0;
+    int genomeSize = 0;
+    int textTeeth = 60;
+    double textLength = 9.81 / (2 * 3.14 * 2 * 3.14);
+    bool isUnknown = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string argument = argv[i];
+        if (argument.compare(0, 6, "--out=") == 0)
+            outputPath = argument.substr(6);
+        else if (argument.compare(0, 9, "--selmag=") == 0)
+            pressure = atoi(argument.c_str() + 9);
+        else if (argument.compare(0, 10, "--threads=") == 0)
+            numThreads = atoi(argument.c_str() + 10);
+        else if (argument.compare(0, 9, "--genome=") == 0)
+            genomeSize = atoi(argument.c_str() + 9);
+        else if (argument.compare(0, 8, "--teeth=") == 0)
+            textTeeth = atoi(argument.c_str() + 8);
+        else if (argument.compare(0, 9, "--length=") == 0)
+            textLength = atof(argument.c_str() + 9);
+        else if (inputPath.empty() && argument.compare(0, 2, "--") != 0)
+            inputPath = argument;
+        else
+            isUnknown = true;
+    }
+
+    if (inputPath.empty() || isUnknown)
+    {
+        cerr << "usage: scoregenomes <file> [--out=file.csv] [--selmag=N] [--threads=N] [--genome=N] [--teeth=N] [--length=L]" << endl;
+        return 1;
+    }
+
+    if (pressure < 1 || genomeSize < 0 || genomeSize > 50 || textTeeth < 0 || textLength < 0)
+    {
+        cerr << "scoregenomes needs a selective pressure of at least 1, a genome size from 1 to 50, and teeth and lengths that aren't negative" << endl;
+        return 1;
+    }
+
+    genomeReader reader;
+    if (!reader.open(inputPath, genomeSize, textTeeth, textLength))
+    {
+        cerr << "Can't read genome file '" << inputPath << "': " << reader.getError() << endl;
+        return 1;
+    }
+    genomeSize = reader.getGenomeSize();
+
+    FILE * out = stdout;
+    if (!outputPath.empty() && (out = fopen(outputPath.c_str(), "w")) == NULL)
+    {
+        cerr << "Can't open '" << outputPath << "'" << endl;
+        return 1;
+    }
+
+    fprintf(out, "genome,survival_score,pendulum_interval,sec_gear_interval,min_gear_interval,hr_gear_interval,hands,pieces\n");
+
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    workPool pool(numThreads);
+    int numParts = pool.size() * PARTS_PER_THREAD;
+    long chunkGenomes = max(1L, CHUNK_CELLS / (genomeSize * genomeSize));
+    long numScored = 0;
+
+    //  one chunk is scored while the next is read
+    scoreChunk chunks[2];
+    chunks[0].mFirstIndex = 0;
+    chunks[0].mNumGenomes = reader.read(chunks[0].mGenomes, chunkGenomes);
+
+    for (int current = 0; chunks[current].mNumGenomes > 0; current = 1 - current)
+    {
+        scoreChunk & chunk = chunks[current];
+        scoreChunk & next = chunks[1 - current];
+        chunk.mLines.resize(numParts);
+
+        for (int p = 0; p < numParts; p++)
+        {
+            long first = chunk.mNumGenomes * p / numParts;
+            long last = chunk.mNumGenomes * (p + 1) / numParts;
+            if (first == last)
+            {
+                chunk.mLines[p].clear();
+                continue;
+            }
+
+            pool.submit([&chunk, first, last, genomeSize, pressure, p]()
+            {
+                scoreGenomes(chunk, first, last, genomeSize, pressure, chunk.mLines[p]);
+            });
+        }
+
+        next.mFirstIndex = chunk.mFirstIndex + chunk.mNumGenomes;
+        next.mNumGenomes = reader.read(next.mGenomes, chunkGenomes);
+        pool.wait();
+
+        for (int p = 0; p < numParts; p++)
+            fwrite(chunk.mLines[p].data(), 1, chunk.mLines[p].size(), out);
+        numScored += chunk.mNumGenomes;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    bool isWritten = (fflush(out) == 0 && !ferror(out));
+    if (out != stdout)
+        isWritten = (fclose(out) == 0) && isWritten;
+
+    if (!reader.getError().empty())
+    {
+        cerr << "Stopped reading '" << inputPath << "' after " << numScored << " genomes: " << reader.getError() << endl;
+        return 1;
+    }
+    if (!isWritten)
+    {
+        cerr << "Couldn't write all the scores" << endl;
+        return 1;
+    }
+
+    fprintf(stderr, "Scored %ld genomes of size %d on %d threads in %.3f seconds (%.0f genomes per second)\n", numScored, genomeSize,
+        pool.size(), seconds, (seconds > 0) ? numScored / seconds : 0.);
+
+    return 0;
+}
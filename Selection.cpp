@@ -0,0 +1,85 @@
+//  this file defines the selection schemes that pick parents from the whole population
+#include "Selection.h"
+
+#include <algorithm>
+
+using namespace std;
+
+//  build the table with Vose's method
+void aliasTable::build(const vector<double> & weights)
+{
+    int size = (int)weights.size();
+    double totalWeight = 0;
+
+    for (int i = 0; i < size; i++)
+        totalWeight += weights[i];
+
+    mProbability.resize(size);
+    mAlias.resize(size);
+    mSmall.clear();
+    mLarge.clear();
+
+    //  scale the weights so the average column is exactly full
+    for (int i = 0; i < size; i++)
+    {
+        mProbability[i] = (totalWeight > 0) ? weights[i] * size / totalWeight : 1;
+        mAlias[i] = i;
+
+        if (mProbability[i] < 1)
+            mSmall.push_back(i);
+        else
+            mLarge.push_back(i);
+    }
+
+    //  top up each under-full column with part of an over-full one
+    while (!mSmall.empty() && !mLarge.empty())
+    {
+        int small = mSmall.back();
+        int large = mLarge.back();
+        mSmall.pop_back();
+        mLarge.pop_back();
+
+        mAlias[small] = large;
+        mProbability[large] += mProbability[small] - 1;
+
+        if (mProbability[large] < 1)
+            mSmall.push_back(large);
+        else
+            mLarge.push_back(large);
+    }
+
+    //  whatever is left over is full, give or take rounding
+    for (int i = 0; i < (signed int)mSmall.size(); i++)
+        mProbability[mSmall[i]] = 1;
+    for (int i = 0; i < (signed int)mLarge.size(); i++)
+        mProbability[mLarge[i]] = 1;
+}
+
+int aliasTable::draw(MTRand & randGen) const
+{
+    int column = randGen.randInt(mProbability.size() - 1);
+
+    if (randGen.randExc() < mProbability[column])
+        return column;
+
+    return mAlias[column];
+}
+
+void calcRankWeights(const vector<double> & scores, double pressure, vector<double> & weights)
+{
+    int size = (int)scores.size();
+    vector<int> order(size);
+
+    for (int i = 0; i < size; i++)
+        order[i] = i;
+
+    //  rank the clocks from worst to best
+    stable_sort(order.begin(), order.end(), [&scores](int a, int b)
+    {
+        return scores[a] < scores[b];
+    });
+
+    weights.resize(size);
+    for (int rank = 0; rank < size; rank++)
+        weights[order[rank]] = (size > 1) ? (2 - pressure) + 2 * (pressure - 1) * rank / (size - 1) : 1;
+}
@@ -0,0 +1,45 @@
+//  this file contains the selection schemes that pick parents from the whole population
+
+#ifndef SELECTION_H_INCLUDED
+#define SELECTION_H_INCLUDED
+
+#include <vector>
+#include "MersenneTwister.h"
+
+using namespace std;
+
+//  ways the world can choose which clocks mate
+const int SELECT_TOURNAMENT = 0;
+const int SELECT_ROULETTE = 1;
+const int SELECT_RANK = 2;
+
+//  Walker alias table, which draws an index with probability proportional to its weight in constant time
+class aliasTable
+{
+private:
+
+    //  chance of keeping the drawn column rather than taking its alias
+    vector<double> mProbability;
+
+    //  the other index that shares each column
+    vector<int> mAlias;
+
+    //  scratch lists of under- and over-full columns used while building
+    vector<int> mSmall;
+    vector<int> mLarge;
+
+public:
+
+    //  builds the table from a list of weights in O(N); if every weight is zero, all indexes are equally likely
+    void build(const vector<double> & weights);
+
+    //  draws an index; the table isn't changed, so any number of threads can draw at once with their own generators
+    int draw(MTRand & randGen) const;
+
+    int size() const {return (int)mProbability.size();};
+};
+
+//  fills 'weights' with linear rank weights for 'scores', from (2 - pressure) for the worst clock to 'pressure' for the best
+void calcRankWeights(const vector<double> & scores, double pressure, vector<double> & weights);
+
+#endif // SELECTION_H_INCLUDED
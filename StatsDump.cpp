@@ -0,0 +1,41 @@
+//  this file is a small tool that prints a binary stats file as comma-separated text at full precision
+#include "StatsFile.h"
+
+#include <cstdio>
+
+int main(int argc, char * argv[])
+{
+    if (argc != 2)
+    {
+        cerr << "usage: statsdump <file>_averages.bin" << endl;
+        return 1;
+    }
+
+    statsReader reader;
+    if (!reader.open(argv[1]))
+    {
+        cerr << "Can't read stats file '" << argv[1] << "'" << endl;
+        return 1;
+    }
+
+    //  the settings go in a comment line, as in the text stats file
+    printf("#");
+    for (int i = 0; i < reader.getNumSettings(); i++)
+        printf("%s %s %.17g", (i > 0 ? "," : ""), reader.getSettingName(i).c_str(), reader.getSettingValue(i));
+    printf("\n");
+
+    for (int i = 0; i < reader.getNumColumns(); i++)
+        printf("%s%s", (i > 0 ? "," : ""), reader.getColumnName(i).c_str());
+    printf("\n");
+
+    //  walk the mapped chunks directly, column pointers and all
+    for (int chunk = 0; chunk < reader.getNumChunks(); chunk++)
+        for (size_t row = 0; row < reader.getChunkRows(chunk); row++)
+        {
+            for (int column = 0; column < reader.getNumColumns(); column++)
+                printf("%s%.17g", (column > 0 ? "," : ""), reader.getChunkColumn(chunk, column)[row]);
+            printf("\n");
+        }
+
+    return 0;
+}
@@ -0,0 +1,269 @@
+//  this file defines the binary columnar stats format
+#include "StatsFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+//  writes a name padded out to its fixed size
+static void writeName(ofstream & file, string name)
+{
+    char field[STATS_NAME_SIZE];
+
+    memset(field, 0, sizeof(field));
+    name.copy(field, STATS_NAME_SIZE - 1);
+    file.write(field, sizeof(field));
+}
+
+//  reads a fixed-size name
+static string readName(const char * field)
+{
+    return string(field, strnlen(field, STATS_NAME_SIZE));
+}
+
+statsWriter::statsWriter()
+{
+    mNumColumns = 0;
+    mChunkRows = 0;
+    mWriter = NULL;
+}
+
+statsWriter::~statsWriter()
+{
+    close();
+}
+
+bool statsWriter::open(string path, varData settings, const vector<string> & columnNames)
+{
+    mFile.open(path.c_str(), ios::binary | ios::trunc);
+    if (!mFile)
+        return false;
+
+    mNumColumns = (int)columnNames.size();
+    mChunk.assign((size_t)mNumColumns * STATS_CHUNK_ROWS, 0);
+    mChunkRows = 0;
+
+    //  every setting that changes what a run does
+    const char * settingNames[] = {"pop", "gens", "mrate", "genome", "selmag", "tsize", "selmode", "rankp", "window", "target", "mindiv",
+        "minhamming", "islands", "migint", "migrants"};
+    double settingValues[] = {settings.mPopulationSize, settings.mNumGenerations, settings.mMutationRate, (double)settings.mGenomeSize,
+        (double)settings.mSelectivePressureMagnitude, (double)settings.mTournamentSize, (double)settings.mSelectionMode, settings.mRankPressure,
+        (double)settings.mStallWindow, settings.mTargetScore, settings.mMinDiversity, settings.mMinGeneDiversity, (double)settings.mNumIslands,
+        (double)settings.mMigrationInterval, (double)settings.mNumMigrants};
+    uint32_t numSettings = sizeof(settingValues) / sizeof(settingValues[0]);
+
+    uint32_t header[4] = {(uint32_t)STATS_VERSION, (uint32_t)mNumColumns, numSettings, 0};
+    mFile.write(STATS_MAGIC, sizeof(STATS_MAGIC));
+    mFile.write((const char *)header, sizeof(header));
+
+    for (uint32_t i = 0; i < numSettings; i++)
+    {
+        writeName(mFile, settingNames[i]);
+        mFile.write((const char *)&settingValues[i], sizeof(double));
+    }
+
+    for (int i = 0; i < mNumColumns; i++)
+        writeName(mFile, columnNames[i]);
+
+    return (bool)mFile;
+}
+
+bool statsWriter::reopen(string path, int numColumns, long fileSize)
+{
+    if (truncate(path.c_str(), fileSize) != 0)
+        return false;
+
+    mFile.open(path.c_str(), ios::binary | ios::app);
+    if (!mFile)
+        return false;
+
+    mNumColumns = numColumns;
+    mChunk.assign((size_t)mNumColumns * STATS_CHUNK_ROWS, 0);
+    mChunkRows = 0;
+
+    return true;
+}
+
+void statsWriter::addRow(const double * values)
+{
+    //  the chunk is stored column by column, so each value goes in its column's run
+    for (int i = 0; i < mNumColumns; i++)
+        mChunk[(size_t)i * STATS_CHUNK_ROWS + mChunkRows] = values[i];
+
+    if (++mChunkRows == STATS_CHUNK_ROWS)
+        flush();
+}
+
+void statsWriter::flush()
+{
+    if (!mFile.is_open() || mChunkRows == 0)
+        return;
+
+    //  lay the chunk out as it goes in the file, then write it in one piece
+    uint64_t numRows = mChunkRows;
+    mChunkBytes.append((const char *)&numRows, sizeof(numRows));
+
+    for (int i = 0; i < mNumColumns; i++)
+        mChunkBytes.append((const char *)&mChunk[(size_t)i * STATS_CHUNK_ROWS], sizeof(double) * mChunkRows);
+
+    if (mWriter != NULL)
+    {
+        mWriter->write(mFile, mChunkBytes);
+        mWriter->flush(mFile);
+    }
+    else
+    {
+        mFile.write(mChunkBytes.data(), mChunkBytes.size());
+        mFile.flush();
+        mChunkBytes.clear();
+    }
+
+    mChunkRows = 0;
+}
+
+void statsWriter::close()
+{
+    if (!mFile.is_open())
+        return;
+
+    flush();
+    mFile.close();
+}
+
+statsReader::statsReader()
+{
+    mData = NULL;
+    mSize = 0;
+    mNumRows = 0;
+}
+
+statsReader::~statsReader()
+{
+    close();
+}
+
+bool statsReader::open(string path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size < (off_t)(sizeof(STATS_MAGIC) + 16))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void * data = mmap(NULL, fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    mData = (const char *)data;
+    mSize = fileInfo.st_size;
+
+    //  the columns are read from start to finish
+    madvise(data, mSize, MADV_SEQUENTIAL);
+
+    if (memcmp(mData, STATS_MAGIC, sizeof(STATS_MAGIC)) != 0)
+    {
+        close();
+        return false;
+    }
+
+    const uint32_t * header = (const uint32_t *)(mData + sizeof(STATS_MAGIC));
+    uint32_t numColumns = header[1];
+    uint32_t numSettings = header[2];
+    size_t offset = sizeof(STATS_MAGIC) + 16;
+    size_t headerEnd = offset + (size_t)numSettings * (STATS_NAME_SIZE + sizeof(double)) + (size_t)numColumns * STATS_NAME_SIZE;
+
+    if (header[0] != STATS_VERSION || headerEnd > mSize)
+    {
+        close();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < numSettings; i++)
+    {
+        double value;
+        mSettingNames.push_back(readName(mData + offset));
+        memcpy(&value, mData + offset + STATS_NAME_SIZE, sizeof(value));
+        mSettingValues.push_back(value);
+        offset += STATS_NAME_SIZE + sizeof(double);
+    }
+
+    for (uint32_t i = 0; i < numColumns; i++)
+    {
+        mColumnNames.push_back(readName(mData + offset));
+        offset += STATS_NAME_SIZE;
+    }
+
+    //  index every complete chunk, ignoring one that was cut short
+    while (offset + sizeof(uint64_t) <= mSize)
+    {
+        uint64_t numRows;
+        memcpy(&numRows, mData + offset, sizeof(numRows));
+
+        size_t chunkSize = sizeof(uint64_t) + (size_t)numRows * numColumns * sizeof(double);
+        if (numRows == 0 || offset + chunkSize > mSize)
+            break;
+
+        mChunkData.push_back((const double *)(mData + offset + sizeof(uint64_t)));
+        mChunkRows.push_back(numRows);
+        mChunkFirstRow.push_back(mNumRows);
+        mNumRows += numRows;
+        offset += chunkSize;
+    }
+
+    return true;
+}
+
+void statsReader::close()
+{
+    if (mData != NULL)
+        munmap((void *)mData, mSize);
+
+    mData = NULL;
+    mSize = 0;
+    mNumRows = 0;
+    mSettingNames.clear();
+    mSettingValues.clear();
+    mColumnNames.clear();
+    mChunkData.clear();
+    mChunkRows.clear();
+    mChunkFirstRow.clear();
+}
+
+int statsReader::findColumn(string name)
+{
+    for (int i = 0; i < (signed int)mColumnNames.size(); i++)
+        if (mColumnNames[i] == name)
+            return i;
+
+    return -1;
+}
+
+double statsReader::getValue(size_t row, int column)
+{
+    //  find the last chunk starting at or before the row
+    int chunk = (int)(upper_bound(mChunkFirstRow.begin(), mChunkFirstRow.end(), row) - mChunkFirstRow.begin()) - 1;
+
+    return getChunkColumn(chunk, column)[row - mChunkFirstRow[chunk]];
+}
+
+void statsReader::readColumn(int column, vector<double> & values)
+{
+    values.resize(mNumRows);
+
+    for (int i = 0; i < (signed int)mChunkData.size(); i++)
+        copy(getChunkColumn(i, column), getChunkColumn(i, column) + mChunkRows[i], values.begin() + mChunkFirstRow[i]);
+}
@@ -0,0 +1,130 @@
+//  this file contains the binary columnar format for per-generation statistics, and its memory-mapped reader
+
+#ifndef STATSFILE_H_INCLUDED
+#define STATSFILE_H_INCLUDED
+
+#include "Interface.h"
+#include "Writer.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+LAYOUT OF A STATS FILE (all numbers little-endian, every section a multiple of 8 bytes):
+
+    header   "WESTATS1", uint32 version, uint32 column count, uint32 setting count, uint32 0
+             one 32-byte name and one float64 value per setting
+             one 32-byte name per column
+    chunks   uint64 row count, then each column's values for those rows as float64, column after column
+
+Chunks are only ever appended, so a file cut short by a crash loses at most the chunk being written.
+*/
+
+//  fixed sizes in the file
+const int STATS_NAME_SIZE = 32;
+const int STATS_VERSION = 1;
+const char STATS_MAGIC[8] = {'W', 'E', 'S', 'T', 'A', 'T', 'S', '1'};
+
+//  rows gathered before a chunk is appended
+const int STATS_CHUNK_ROWS = 256;
+
+//  writes rows of float64 values into append-only column chunks
+class statsWriter
+{
+private:
+
+    ofstream mFile;
+    int mNumColumns;
+
+    //  rows of the chunk being gathered, stored column after column
+    vector<double> mChunk;
+    int mChunkRows;
+
+    //  background writer that finished chunks are handed to (NULL writes them directly)
+    asyncWriter * mWriter;
+    string mChunkBytes;
+
+public:
+
+    statsWriter();
+    ~statsWriter();
+
+    //  creates the file and writes the header; returns false if it can't be opened
+    bool open(string path, varData settings, const vector<string> & columnNames);
+
+    //  reopens a file written before, cutting it back to 'fileSize' bytes and appending from there
+    bool reopen(string path, int numColumns, long fileSize);
+
+    bool isOpen() {return mFile.is_open();};
+
+    //  hands finished chunks to a background writer instead of writing them directly
+    void setWriter(asyncWriter * writer) {mWriter = writer;};
+
+    //  adds one row (one value per column)
+    void addRow(const double * values);
+
+    //  appends the gathered rows as a chunk
+    void flush();
+
+    //  appends the last chunk and closes the file
+    void close();
+};
+
+//  reads a stats file by memory-mapping it
+class statsReader
+{
+private:
+
+    //  the mapping
+    const char * mData;
+    size_t mSize;
+
+    vector<string> mSettingNames;
+    vector<double> mSettingValues;
+    vector<string> mColumnNames;
+
+    //  where each complete chunk's values start, how many rows it holds, and the first row it holds
+    vector<const double *> mChunkData;
+    vector<size_t> mChunkRows;
+    vector<size_t> mChunkFirstRow;
+    size_t mNumRows;
+
+    statsReader (const statsReader &);
+    statsReader & operator= (const statsReader &);
+
+public:
+
+    statsReader();
+    ~statsReader();
+
+    //  maps a file and indexes its chunks; returns false if it isn't a stats file
+    bool open(string path);
+    void close();
+
+    size_t getNumRows() {return mNumRows;};
+    int getNumColumns() {return (int)mColumnNames.size();};
+    string getColumnName(int column) {return mColumnNames[column];};
+
+    //  returns the index of a named column, or -1
+    int findColumn(string name);
+
+    //  the settings stored in the header
+    int getNumSettings() {return (int)mSettingNames.size();};
+    string getSettingName(int index) {return mSettingNames[index];};
+    double getSettingValue(int index) {return mSettingValues[index];};
+
+    //  direct access to the mapped values of a column within a chunk
+    int getNumChunks() {return (int)mChunkData.size();};
+    size_t getChunkRows(int chunk) {return mChunkRows[chunk];};
+    const double * getChunkColumn(int chunk, int column) {return mChunkData[chunk] + column * mChunkRows[chunk];};
+
+    //  returns a single value
+    double getValue(size_t row, int column);
+
+    //  copies a whole column out
+    void readColumn(int column, vector<double> & values);
+};
+
+#endif // STATSFILE_H_INCLUDED
@@ -0,0 +1,453 @@
+//  this file defines the memory-mapped population store
+#include "Store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+
+//  marks a stored piece as connected, above the bits of its type
+const unsigned char CONNECTED_BIT = 0x80;
+
+sharedTiles::sharedTiles()
+{
+    //  tile 0, of empty pieces
+    mCells.resize(1);
+    memset(&mCells[0], 0, sizeof(tileCells));
+    mCounts.push_back(0);
+}
+
+uint32_t sharedTiles::add(const tileCells & cells)
+{
+    uint32_t tile;
+    if (!mFree.empty())
+    {
+        tile = mFree.back();
+        mFree.pop_back();
+    }
+    else
+    {
+        tile = mCounts.size();
+        mCounts.push_back(0);
+        mCells.resize(tile + 1);
+    }
+
+    mCells[tile] = cells;
+    mCounts[tile] = 0;
+
+    return tile;
+}
+
+clockStore::clockStore()
+{
+    mData = NULL;
+    mSize = 0;
+    mSummaries = NULL;
+    mGenomes = NULL;
+    mNumClocks = 0;
+    mGenomeSize = 0;
+    mNumCells = 0;
+    mSlotSize = 0;
+    mNumTiles = 0;
+    mScratch = NULL;
+}
+
+clockStore::~clockStore()
+{
+    close();
+}
+
+bool clockStore::open(string directory, long numClocks, int genomeSize, bool isShared, clockStore * sharesWith)
+{
+    close();
+
+    //  the file only needs a name until it's mapped, so it can't be left behind however the run ends
+    string path = directory + "population.XXXXXX";
+    vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+
+    int fd = mkstemp(&name[0]);
+    if (fd < 0)
+        return false;
+    unlink(&name[0]);
+
+    //  the genomes start on a page of their own, so access advice can be given for them alone
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t summariesSize = (numClocks * sizeof(clockSummary) + pageSize - 1) / pageSize * pageSize;
+
+    mNumClocks = numClocks;
+    mGenomeSize = genomeSize;
+    mNumCells = genomeSize * genomeSize;
+    mNumTiles = isShared ? (mNumCells + TILE_CELLS - 1) / TILE_CELLS : 0;
+    mSlotSize = (mNumCells * (isShared ? 1 : sizeof(double) + 1) + mNumTiles * sizeof(uint32_t) + 7) / 8 * 8;
+    mSize = summariesSize + numClocks * mSlotSize;
+
+    //  a new file reads as zeros, which is an empty clock that has never been scored
+    void * data = MAP_FAILED;
+    if (ftruncate(fd, mSize) == 0)
+        data = mmap(NULL, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        mSize = 0;
+        mNumTiles = 0;
+        return false;
+    }
+
+    mData = (char *)data;
+    mSummaries = (clockSummary *)mData;
+    mGenomes = mData + summariesSize;
+
+    mGenes.assign(mNumCells, NULL_GENE);
+    mScratch = new bioClock(mGenomeSize, &mGenes[0]);
+
+    if (isShared)
+        mTiles = (sharesWith != NULL && sharesWith->mTiles) ? sharesWith->mTiles : make_shared<sharedTiles>();
+
+    return true;
+}
+
+void clockStore::close()
+{
+    //  tiles still shared with another store stay until it's done with them too
+    if (mData != NULL && mTiles.use_count() > 1)
+        for (long i = 0; i < mNumClocks; i++)
+            for (int j = 0; j < mNumTiles; j++)
+                mTiles->release(getTiles(i)[j]);
+    mTiles.reset();
+
+    if (mData != NULL)
+        munmap(mData, mSize);
+
+    delete mScratch;
+
+    mData = NULL;
+    mSize = 0;
+    mSummaries = NULL;
+    mGenomes = NULL;
+    mNumClocks = 0;
+    mNumTiles = 0;
+    mScratch = NULL;
+}
+
+void clockStore::setCell(double * values, unsigned char * types, int cell, pieceGene gene)
+{
+    types[cell] = (unsigned char)gene.mPieceType;
+
+    if (gene.mPieceType == PTYPE_PENDULUM)
+        values[cell] = gene.mPendulumLength;
+    else if (gene.mPieceType == PTYPE_GEAR)
+        values[cell] = gene.mNumTeeth;
+    else
+        values[cell] = 0;
+}
+
+int clockStore::beginTile(int tile)
+{
+    //  the padding of the last tile is always empty pieces, so whole tiles can be compared
+    int tileCells = min(TILE_CELLS, mNumCells - tile * TILE_CELLS);
+    for (int i = tileCells; i < TILE_CELLS; i++)
+    {
+        mTile.mValues[i] = 0;
+        mTile.mTypes[i] = 0;
+    }
+
+    return tileCells;
+}
+
+void clockStore::setTile(uint32_t * tiles, int tile, uint32_t newTile)
+{
+    if (tiles[tile] == newTile)
+        return;
+
+    mTiles->retain(newTile);
+    mTiles->release(tiles[tile]);
+    tiles[tile] = newTile;
+}
+
+uint32_t clockStore::findTile(uint32_t tile1, uint32_t tile2)
+{
+    uint32_t sameTile[2] = {tile1, tile2};
+
+    for (int i = 0; i < 2; i++)
+        if (memcmp(mTiles->getTypes(sameTile[i]), mTile.mTypes, TILE_CELLS) == 0
+            && memcmp(mTiles->getValues(sameTile[i]), mTile.mValues, TILE_CELLS * sizeof(double)) == 0)
+            return sameTile[i];
+
+    return mTiles->add(mTile);
+}
+
+void clockStore::randomClock(long index)
+{
+    if (mTiles)
+    {
+        uint32_t * tiles = getTiles(index);
+
+        for (int t = 0; t < mNumTiles; t++)
+        {
+            int tileCells = beginTile(t);
+            for (int i = 0; i < tileCells; i++)
+            {
+                clockPiece tempPiece;
+                setCell(mTile.mValues, mTile.mTypes, i, tempPiece.getGene());
+            }
+            setTile(tiles, t, findTile(0, 0));
+        }
+        memset(getTypes(index), 0, mNumCells);
+    }
+    else
+    {
+        double * values = getValues(index);
+        unsigned char * types = getTypes(index);
+
+        for (int i = 0; i < mNumCells; i++)
+        {
+            clockPiece tempPiece;
+            setCell(values, types, i, tempPiece.getGene());
+        }
+    }
+
+    memset(&mSummaries[index], 0, sizeof(clockSummary));
+}
+
+void clockStore::breed(clockStore & parents, long parent1, long parent2, long child, double mutationRate)
+{
+    if (mTiles)
+    {
+        breedTiles(parents, parent1, parent2, child, mutationRate);
+        return;
+    }
+
+    MTRand & randGen = simRand();
+    double remainingPercent = 1 - (mutationRate / 100);
+
+    double * values = getValues(child);
+    unsigned char * types = getTypes(child);
+    const double * values1 = parents.getValues(parent1);
+    const unsigned char * types1 = parents.getTypes(parent1);
+    const double * values2 = parents.getValues(parent2);
+    const unsigned char * types2 = parents.getTypes(parent2);
+
+    //  each cell is a mutation or a copy of one parent's, decided the same way the clock constructor does
+    for (int i = 0; i < mNumCells; i++)
+    {
+        double randNum = randGen.rand();
+
+        if (randNum > remainingPercent)
+        {
+            clockPiece tempPiece;
+            setCell(values, types, i, tempPiece.getGene());
+        }
+        else if (randNum > (remainingPercent / 2))
+        {
+            values[i] = values1[i];
+            types[i] = types1[i] & ~CONNECTED_BIT;
+        }
+        else
+        {
+            values[i] = values2[i];
+            types[i] = types2[i] & ~CONNECTED_BIT;
+        }
+    }
+
+    memset(&mSummaries[child], 0, sizeof(clockSummary));
+}
+
+//  where a child's cell comes from
+const unsigned char FROM_PARENT1 = 0;
+const unsigned char FROM_PARENT2 = 1;
+const unsigned char FROM_MUTATION = 2;
+
+void clockStore::breedTiles(clockStore & parents, long parent1, long parent2, long child, double mutationRate)
+{
+    MTRand & randGen = simRand();
+    double remainingPercent = 1 - (mutationRate / 100);
+
+    uint32_t * tiles = getTiles(child);
+    const uint32_t * tiles1 = parents.getTiles(parent1);
+    const uint32_t * tiles2 = parents.getTiles(parent2);
+
+    for (int t = 0; t < mNumTiles; t++)
+    {
+        int tileCells = beginTile(t);
+        uint32_t tile1 = tiles1[t];
+        uint32_t tile2 = tiles2[t];
+        int numSources[3] = {0, 0, 0};
+
+        //  the same draws as breed(), but only a mutation is written down as it's drawn (its piece draws random numbers too)
+        for (int i = 0; i < tileCells; i++)
+        {
+            double randNum = randGen.rand();
+
+            if (randNum > remainingPercent)
+            {
+                clockPiece tempPiece;
+                setCell(mTile.mValues, mTile.mTypes, i, tempPiece.getGene());
+                mCellSources[i] = FROM_MUTATION;
+            }
+            else
+                mCellSources[i] = (randNum > (remainingPercent / 2)) ? FROM_PARENT1 : FROM_PARENT2;
+
+            numSources[mCellSources[i]]++;
+        }
+
+        //  a tile taken whole from one parent, or from two parents with the same tile, is shared without being read at all
+        if (numSources[FROM_MUTATION] == 0 && (numSources[FROM_PARENT2] == 0 || tile1 == tile2))
+            setTile(tiles, t, tile1);
+        else if (numSources[FROM_MUTATION] == 0 && numSources[FROM_PARENT1] == 0)
+            setTile(tiles, t, tile2);
+        else
+        {
+            const double * values1 = mTiles->getValues(tile1);
+            const unsigned char * types1 = mTiles->getTypes(tile1);
+            const double * values2 = mTiles->getValues(tile2);
+            const unsigned char * types2 = mTiles->getTypes(tile2);
+
+            for (int i = 0; i < tileCells; i++)
+            {
+                if (mCellSources[i] == FROM_PARENT1)
+                {
+                    mTile.mValues[i] = values1[i];
+                    mTile.mTypes[i] = types1[i];
+                }
+                else if (mCellSources[i] == FROM_PARENT2)
+                {
+                    mTile.mValues[i] = values2[i];
+                    mTile.mTypes[i] = types2[i];
+                }
+            }
+
+            //  a mix of parents that only differ where it didn't take from both, or a mutation to what was there, is
+            //  still one of theirs
+            setTile(tiles, t, findTile(tile1, tile2));
+        }
+    }
+
+    memset(getTypes(child), 0, mNumCells);
+    memset(&mSummaries[child], 0, sizeof(clockSummary));
+}
+
+double clockStore::score(long index)
+{
+    double survivalScore = unpack(index).calcSurvivalScore();
+    mSummaries[index] = mScratch->getSummary();
+    saveConnections(getTypes(index));
+
+    return survivalScore;
+}
+
+void clockStore::saveConnections(unsigned char * types)
+{
+    for (int i = 0; i < mNumCells; i++)
+        types[i] = (types[i] & ~CONNECTED_BIT) | (mScratch->isConnected(i / mGenomeSize, i % mGenomeSize) ? CONNECTED_BIT : 0);
+}
+
+void clockStore::getGenome(long index, pieceGene * genome)
+{
+    const double * values = getValues(index);
+    const unsigned char * types = getTypes(index);
+    int firstCell = 0;
+
+    //  a clock's tiles can be anywhere, so they're all asked for before any is read
+    if (mTiles)
+        for (int t = 0; t < mNumTiles; t++)
+            mTiles->prefetch(getTiles(index)[t]);
+
+    for (int i = 0; i < mNumCells; i++)
+    {
+        //  a shared store's values and types come from the tile each cell is in instead
+        if (mTiles && i % TILE_CELLS == 0)
+        {
+            uint32_t tile = getTiles(index)[i / TILE_CELLS];
+            values = mTiles->getValues(tile);
+            types = mTiles->getTypes(tile);
+            firstCell = i;
+        }
+
+        genome[i] = NULL_GENE;
+        genome[i].mPieceType = types[i - firstCell] & ~CONNECTED_BIT;
+
+        if (genome[i].mPieceType == PTYPE_PENDULUM)
+            genome[i].mPendulumLength = values[i - firstCell];
+        else if (genome[i].mPieceType == PTYPE_GEAR)
+            genome[i].mNumTeeth = (int)values[i - firstCell];
+    }
+}
+
+bioClock & clockStore::unpack(long index)
+{
+    const unsigned char * types = getTypes(index);
+
+    getGenome(index, &mGenes[0]);
+    mScratch->setGenome(&mGenes[0]);
+    mScratch->setSummary(mSummaries[index]);
+
+    for (int i = 0; i < mNumCells; i++)
+        if (types[i] & CONNECTED_BIT)
+            mScratch->setConnected(i / mGenomeSize, i % mGenomeSize, true);
+
+    return *mScratch;
+}
+
+void clockStore::pack(long index, bioClock & clock)
+{
+    double * values = getValues(index);
+    unsigned char * types = getTypes(index);
+
+    clock.getGenome(&mGenes[0]);
+    if (mTiles)
+    {
+        //  tiles that haven't changed stay shared
+        uint32_t * tiles = getTiles(index);
+        for (int t = 0; t < mNumTiles; t++)
+        {
+            int tileCells = beginTile(t);
+            for (int i = 0; i < tileCells; i++)
+                setCell(mTile.mValues, mTile.mTypes, i, mGenes[t * TILE_CELLS + i]);
+            setTile(tiles, t, findTile(tiles[t], 0));
+        }
+        memset(types, 0, mNumCells);
+    }
+    else
+    {
+        for (int i = 0; i < mNumCells; i++)
+            setCell(values, types, i, mGenes[i]);
+    }
+
+    mSummaries[index] = clock.getSummary();
+    if (&clock == mScratch)
+        saveConnections(types);
+}
+
+void clockStore::prefetch(long index)
+{
+    __builtin_prefetch(&mSummaries[index], 1);
+    __builtin_prefetch(getValues(index));
+    __builtin_prefetch(getTypes(index));
+}
+
+void clockStore::adviseSequential(bool isSequential)
+{
+    if (mData != NULL)
+        madvise(mGenomes, mSize - (mGenomes - mData), isSequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+}
+
+void clockStore::swap(clockStore & other)
+{
+    std::swap(mData, other.mData);
+    std::swap(mSize, other.mSize);
+    std::swap(mSummaries, other.mSummaries);
+    std::swap(mGenomes, other.mGenomes);
+    std::swap(mNumClocks, other.mNumClocks);
+    std::swap(mGenomeSize, other.mGenomeSize);
+    std::swap(mNumCells, other.mNumCells);
+    std::swap(mSlotSize, other.mSlotSize);
+    mTiles.swap(other.mTiles);
+    std::swap(mNumTiles, other.mNumTiles);
+    std::swap(mScratch, other.mScratch);
+    mGenes.swap(other.mGenes);
+}
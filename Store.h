@@ -0,0 +1,174 @@
+//  this file contains the population store, which keeps packed genomes in a memory-mapped file so a population can outgrow memory
+
+#ifndef STORE_H_INCLUDED
+#define STORE_H_INCLUDED
+
+#include "Clock.h"
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+using namespace std;
+
+/*
+LAYOUT OF A STORE FILE (the file is removed as soon as it's mapped, so only the process that made it ever sees it):
+
+    summaries   one clockSummary per clock, holding the scores and whatever else the last evaluation left behind
+    genomes     one slot per clock: genomeSize^2 float64 values, then genomeSize^2 uint8 piece types, padded to 8 bytes
+
+A value is the number of teeth of a gear, the length of a pendulum, and 0 for any other piece.
+The top bit of a piece type is set once the piece has been found connected to the rest of its clock, which a clock
+in memory remembers between evaluations too, and which saves finding the connections all over again.
+The summaries are read for every clock each generation, so they're kept together rather than beside each genome.
+
+A store of shared tiles has a different slot: one uint32 tile number per 8 cells of the genome (its cells taken row by
+row), then genomeSize^2 uint8 connection marks (the top bit, as above), padded to 8 bytes. The tiles themselves are in
+memory, can't be changed once made, and are counted, so any number of clocks, in this store or one it breeds with, can
+point to the same tile; the last one's padded with empty pieces. A child points to its parent's tile wherever its genes
+come out the same, which once the population has converged is nearly everywhere, and only a tile that really mixes its
+parents or mutates is made anew. Tile 0 is all empty pieces, so a new file still reads as empty clocks.
+*/
+
+//  cells in a shared tile
+const int TILE_CELLS = 8;
+
+//  a tile's cells, kept together so reading one is a single trip to memory or two
+struct tileCells
+{
+    double mValues[TILE_CELLS];
+    unsigned char mTypes[TILE_CELLS];
+};
+
+//  the tiles shared by the clocks of one or more stores, each with the number of clocks pointing to it
+class sharedTiles
+{
+private:
+
+    vector<tileCells> mCells;
+    vector<uint32_t> mCounts;
+
+    //  tiles no clock points to any more, to be reused before new ones are made
+    vector<uint32_t> mFree;
+
+public:
+
+    sharedTiles();
+
+    //  a tile's cells, valid until the next tile is added
+    const double * getValues(uint32_t tile) {return mCells[tile].mValues;};
+    const unsigned char * getTypes(uint32_t tile) {return mCells[tile].mTypes;};
+
+    //  starts loading a tile into the cache ahead of reading it
+    void prefetch(uint32_t tile) {__builtin_prefetch(&mCells[tile]); __builtin_prefetch((const char *)&mCells[tile] + sizeof(tileCells) - 1);};
+
+    //  adds a tile holding a copy of 'cells', which nothing points to yet
+    uint32_t add(const tileCells & cells);
+
+    //  counts one more or one fewer clock pointing to a tile (tile 0 isn't counted, and is never freed)
+    void retain(uint32_t tile) {if (tile != 0) mCounts[tile]++;};
+    void release(uint32_t tile) {if (tile != 0 && --mCounts[tile] == 0) mFree.push_back(tile);};
+};
+
+//  holds a population packed into a memory-mapped file, and breeds and scores its clocks where they lie
+class clockStore
+{
+private:
+
+    //  the mapping, and where its two parts start
+    char * mData;
+    size_t mSize;
+    clockSummary * mSummaries;
+    char * mGenomes;
+
+    long mNumClocks;
+    int mGenomeSize;
+    int mNumCells;
+    size_t mSlotSize;
+
+    //  the tiles the genes are kept in, shared with any store this one breeds with (none unless the store is shared), the
+    //  number of tiles in a genome, and a tile being put together, with where each of its cells came from
+    shared_ptr<sharedTiles> mTiles;
+    int mNumTiles;
+    tileCells mTile;
+    unsigned char mCellSources[TILE_CELLS];
+
+    //  a clock that stored clocks are unpacked into to be scored or written out, and the genes passed through on the way
+    bioClock * mScratch;
+    vector<pieceGene> mGenes;
+
+    //  the parts of a slot: a shared store has tile numbers instead of values, and its types are only the connection marks
+    double * getValues(long index) {return (double *)(mGenomes + index * mSlotSize);};
+    uint32_t * getTiles(long index) {return (uint32_t *)(mGenomes + index * mSlotSize);};
+    unsigned char * getTypes(long index) {return (unsigned char *)(mGenomes + index * mSlotSize) + mNumCells * (mTiles ? 0 : sizeof(double))
+        + mNumTiles * sizeof(uint32_t);};
+
+    //  packs one piece into a slot
+    void setCell(double * values, unsigned char * types, int cell, pieceGene gene);
+
+    //  starts putting a tile of a genome together, returning its cells (fewer than TILE_CELLS only in the last)
+    int beginTile(int tile);
+
+    //  points tile 'tile' of a slot's tiles at 'newTile'
+    void setTile(uint32_t * tiles, int tile, uint32_t newTile);
+
+    //  the tile the tile being put together is the same as, out of 'tile1' and 'tile2', or else a new one holding it
+    uint32_t findTile(uint32_t tile1, uint32_t tile2);
+
+    //  breeds a child into a shared store
+    void breedTiles(clockStore & parents, long parent1, long parent2, long child, double mutationRate);
+
+    //  copies the connections the scratch clock found back into a slot
+    void saveConnections(unsigned char * types);
+
+    clockStore (const clockStore &);
+    clockStore & operator= (const clockStore &);
+
+public:
+
+    clockStore();
+    ~clockStore();
+
+    //  makes a store for 'numClocks' empty clocks in a file in 'directory', with their genes in shared tiles if 'isShared',
+    //  sharing them with 'sharesWith' (NULL for none), which a shared store has to do to breed clocks from or into another
+    //  store; returns false if it can't be made
+    bool open(string directory, long numClocks, int genomeSize, bool isShared, clockStore * sharesWith);
+    void close();
+
+    bool isOpen() {return mData != NULL;};
+    long size() {return mNumClocks;};
+    int getGenomeSize() {return mGenomeSize;};
+
+    //  fills a slot with a random clock, drawing the same random numbers as bioClock(genomeSize)
+    void randomClock(long index);
+
+    //  fills slot 'child' with a child of two clocks of 'parents' (which can be this store, and has to be the same kind),
+    //  drawing the same random numbers as bioClock(source1, source2)
+    void breed(clockStore & parents, long parent1, long parent2, long child, double mutationRate);
+
+    //  scores a clock, starting from what it kept from the last time, the same as bioClock::calcSurvivalScore()
+    double score(long index);
+
+    //  what a clock kept from its last evaluation
+    const clockSummary & getSummary(long index) {return mSummaries[index];};
+    void setScored(long index, int isScored) {mSummaries[index].mIsScored = isScored;};
+
+    //  copies a clock's genes out row by row
+    void getGenome(long index, pieceGene * genome);
+
+    //  unpacks a clock with its summary into a scratch clock, which stays valid until the store is next used
+    bioClock & unpack(long index);
+
+    //  packs a clock and its summary into a slot
+    void pack(long index, bioClock & clock);
+
+    //  starts loading a clock's summary and genome into the cache ahead of using it
+    void prefetch(long index);
+
+    //  tells the system whether the genomes are about to be read in order or at random
+    void adviseSequential(bool isSequential);
+
+    //  trades contents with another store
+    void swap(clockStore & other);
+};
+
+#endif // STORE_H_INCLUDED
@@ -0,0 +1,252 @@
+//  this file defines the parameter sweep
+#include "Sweep.h"
+#include "Pool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+
+using namespace std;
+
+bool parseSweepValues(string text, vector<double> & values)
+{
+    stringstream list(text);
+    string item;
+
+    while (getline(list, item, ','))
+    {
+        double start, stop, step;
+        char sep1, sep2;
+        stringstream range(item);
+
+        //  a range covers start to stop inclusive
+        if (item.find(':') != string::npos)
+        {
+            if (!(range >> start >> sep1 >> stop >> sep2 >> step) || sep1 != ':' || sep2 != ':' || step <= 0 || stop < start || !range.eof())
+                return false;
+
+            //  count the steps rather than adding them up, so rounding can't skip the last value
+            int numSteps = (int)((stop - start) / step + 1e-9);
+            for (int i = 0; i <= numSteps; i++)
+                values.push_back(start + i * step);
+        }
+        else
+        {
+            if (!(range >> start) || !range.eof())
+                return false;
+
+            values.push_back(start);
+        }
+    }
+
+    return !values.empty();
+}
+
+//  runs one job and stores its results in it
+static void runSweepJob(sweepJob & job)
+{
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    //  every configuration's nth replicate starts from the same random numbers, so they're compared on the same draws
+    if (job.mSettings.mSeed > 0)
+        seedSimRand((unsigned long)job.mSettings.mSeed, job.mReplicate + 1);
+
+    world simulation(job.mSettings);
+    simulation.initClocks();
+    simulation.mateClocks();
+
+    job.mFinalStats = simulation.getLastStats();
+    job.mGensRun = simulation.getGensRun();
+    job.mSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+}
+
+//  the settings a sweep can take more than one value of
+const int NUM_SWEPT_SETTINGS = 4;
+const char * const SWEPT_NAMES[NUM_SWEPT_SETTINGS] = {"mrate", "selmag", "pop", "genome"};
+
+//  settings of the sweep itself rather than of its simulations, checked the same way (0 threads is one for each core)
+const settingRange REPS_RANGE = {"reps", 1, 1000000, true, NULL, NULL};
+const settingRange THREADS_RANGE = {"threads", 0, 1024, true, NULL, NULL};
+
+//  writes a swept value back out as text, exactly enough that it reads back as the same number
+static string formatSweepValue(double value)
+{
+    char text[32];
+    return string(text, to_chars(text, text + sizeof(text), value).ptr);
+}
+
+int runSweep(int argc, char * argv[])
+{
+    //  the swept settings start out at their defaults, and every value is kept as the text the settings are set from
+    varData baseSettings;
+    double defaults[NUM_SWEPT_SETTINGS] = {baseSettings.mMutationRate, (double)baseSettings.mSelectivePressureMagnitude,
+        baseSettings.mPopulationSize, (double)baseSettings.mGenomeSize};
+    vector<string> sweptValues[NUM_SWEPT_SETTINGS];
+    for (int i = 0; i < NUM_SWEPT_SETTINGS; i++)
+        sweptValues[i].push_back(formatSweepValue(defaults[i]));
+
+    int numReplicates = 1;
+    int numThreads = 0;
+    string outputPath;
+
+    //  every argument is 'name=values', and every value is checked the same way as a flag's before anything runs
+    for (int i = 0; i < argc; i++)
+    {
+        string argument = argv[i];
+        size_t split = argument.find('=');
+        string name = argument.substr(0, split);
+        string text = (split == string::npos) ? "" : argument.substr(split + 1);
+        vector<double> values;
+
+        if (name == "out")
+        {
+            outputPath = text;
+            continue;
+        }
+
+        int swept = 0;
+        while (swept < NUM_SWEPT_SETTINGS && name != SWEPT_NAMES[swept])
+            swept++;
+
+        if (swept < NUM_SWEPT_SETTINGS)
+        {
+            if (split == string::npos || !parseSweepValues(text, values))
+            {
+                cerr << "Can't read sweep argument '" << argument << "'" << endl;
+                return 1;
+            }
+
+            sweptValues[swept].clear();
+            for (int j = 0; j < (signed int)values.size(); j++)
+            {
+                string value = formatSweepValue(values[j]);
+                varData checked = baseSettings;
+                string error = applySetting(checked, name, value);
+                if (!error.empty())
+                {
+                    cerr << argument << ": " << error << endl;
+                    return 1;
+                }
+                sweptValues[swept].push_back(value);
+            }
+        }
+        else if (name == REPS_RANGE.mName || name == THREADS_RANGE.mName)
+        {
+            double value;
+            string error = readSettingValue(name == REPS_RANGE.mName ? REPS_RANGE : THREADS_RANGE, text, value);
+            if (!error.empty())
+            {
+                cerr << argument << ": " << error << endl;
+                return 1;
+            }
+
+            if (name == REPS_RANGE.mName)
+                numReplicates = (int)value;
+            else
+                numThreads = (int)value;
+        }
+        else
+        {
+            //  any other setting has one value, shared by every run
+            string error = applySetting(baseSettings, name, text);
+            if (!error.empty())
+            {
+                cerr << argument << ": " << error << endl;
+                return 1;
+            }
+        }
+    }
+
+    //  every combination of the swept settings, each run 'reps' times
+    vector<sweepJob> jobs;
+    int numConfigs = 0;
+
+    for (int a = 0; a < (signed int)sweptValues[0].size(); a++)
+        for (int b = 0; b < (signed int)sweptValues[1].size(); b++)
+            for (int c = 0; c < (signed int)sweptValues[2].size(); c++)
+                for (int d = 0; d < (signed int)sweptValues[3].size(); d++)
+                {
+                    //  the values were checked when they were read, so setting them can't fail here
+                    varData settings = baseSettings;
+                    int choice[NUM_SWEPT_SETTINGS] = {a, b, c, d};
+                    for (int i = 0; i < NUM_SWEPT_SETTINGS; i++)
+                        applySetting(settings, SWEPT_NAMES[i], sweptValues[i][choice[i]]);
+
+                    for (int r = 0; r < numReplicates; r++)
+                    {
+                        sweepJob job;
+                        job.mSettings = settings;
+                        job.mSettings.mNumIslands = 1;
+                        job.mSettings.mShowInterval = 0;
+                        job.mConfig = numConfigs;
+                        job.mReplicate = r;
+                        job.mGensRun = 0;
+                        job.mSeconds = 0;
+
+                        //  each generation is a mating per clock, and each mating scores whole genomes
+                        job.mCost = job.mSettings.mPopulationSize * job.mSettings.mNumGenerations * job.mSettings.mGenomeSize * job.mSettings.mGenomeSize;
+                        jobs.push_back(job);
+                    }
+                    numConfigs++;
+                }
+
+    //  start the longest jobs first so the short ones fill in the gaps at the end
+    vector<int> order(jobs.size());
+    for (int i = 0; i < (signed int)order.size(); i++)
+        order[i] = i;
+
+    stable_sort(order.begin(), order.end(), [&jobs](int a, int b)
+    {
+        return jobs[a].mCost > jobs[b].mCost;
+    });
+
+    workPool pool(numThreads);
+    mutex progressLock;
+    int numFinished = 0;
+
+    cerr << "Running " << jobs.size() << " jobs (" << numConfigs << " settings x " << numReplicates << " repeats) on " << pool.size() << " threads" << endl;
+
+    for (int i = 0; i < (signed int)order.size(); i++)
+    {
+        sweepJob * job = &jobs[order[i]];
+        pool.submit([job, &jobs, &progressLock, &numFinished]()
+        {
+            runSweepJob(*job);
+
+            lock_guard<mutex> guard(progressLock);
+            numFinished++;
+            cerr << "\rFinished " << numFinished << " of " << jobs.size() << flush;
+        });
+    }
+    pool.wait();
+    cerr << endl;
+
+    //  write every result into one table
+    ofstream tableFile;
+    if (!outputPath.empty())
+    {
+        tableFile.open(outputPath.c_str());
+        if (!tableFile)
+        {
+            cerr << "Can't open '" << outputPath << "'" << endl;
+            return 1;
+        }
+    }
+    ostream & table = outputPath.empty() ? cout : tableFile;
+
+    table << "config,replicate,mrate,selmag,pop,genome,gens,seconds";
+    for (int i = 0; i < NUM_GEN_AVERAGES; i++)
+        table << "," << GEN_AVERAGE_NAMES[i];
+    table << "\n";
+
+    for (int i = 0; i < (signed int)jobs.size(); i++)
+    {
+        table << jobs[i].mConfig << "," << jobs[i].mReplicate << "," << jobs[i].mSettings.mMutationRate << "," << jobs[i].mSettings.mSelectivePressureMagnitude << ","
+        << jobs[i].mSettings.mPopulationSize << "," << jobs[i].mSettings.mGenomeSize << "," << jobs[i].mGensRun << "," << jobs[i].mSeconds << ",";
+        writeGenAverages(table, jobs[i].mFinalStats);
+        table << "\n";
+    }
+    table.flush();
+
+    return 0;
+}
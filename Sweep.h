@@ -0,0 +1,35 @@
+//  this file contains the parameter sweep, which runs many simulation settings in parallel in one process
+
+#ifndef SWEEP_H_INCLUDED
+#define SWEEP_H_INCLUDED
+
+#include "Evolve.h"
+
+using namespace std;
+
+//  one run of one combination of the swept settings
+struct sweepJob
+{
+    //  the settings to run with
+    varData mSettings;
+
+    //  which combination of settings this is, and which repeat of it
+    int mConfig;
+    int mReplicate;
+
+    //  rough cost of the run, used to start the longest runs first
+    double mCost;
+
+    //  results: the last generation's totals, the generations run, and the wall time taken
+    genStats mFinalStats;
+    int mGensRun;
+    double mSeconds;
+};
+
+//  reads a list ("0.5,1,2"), a range ("1:10:3" as start:stop:step) or a mix of both into 'values'
+bool parseSweepValues(string text, vector<double> & values);
+
+//  runs a sweep described by 'name=values' arguments and writes one table of results, returning the exit code
+int runSweep(int argc, char * argv[]);
+
+#endif // SWEEP_H_INCLUDED
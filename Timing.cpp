@@ -0,0 +1,51 @@
+//  this file defines the phase timers
+#include "Timing.h"
+
+thread_local phaseTimes THREAD_PHASE_TIMES = phaseTimes();
+thread_local bool IS_THREAD_TIMED = false;
+thread_local bool IS_THREAD_COUNTED = false;
+thread_local perfCounters THREAD_PERF_COUNTERS;
+
+phaseTimes phaseTimes::operator-(const phaseTimes & earlier) const
+{
+    phaseTimes difference;
+    for (int i = 0; i < NUM_PHASES; i++)
+    {
+        difference.mNanoseconds[i] = mNanoseconds[i] - earlier.mNanoseconds[i];
+        difference.mCounts[i] = mCounts[i] - earlier.mCounts[i];
+        for (int j = 0; j < NUM_PERF_COUNTERS; j++)
+            difference.mEvents[i][j] = mEvents[i][j] - earlier.mEvents[i][j];
+    }
+
+    return difference;
+}
+
+phaseTimes & phaseTimes::operator+=(const phaseTimes & other)
+{
+    for (int i = 0; i < NUM_PHASES; i++)
+    {
+        mNanoseconds[i] += other.mNanoseconds[i];
+        mCounts[i] += other.mCounts[i];
+        for (int j = 0; j < NUM_PERF_COUNTERS; j++)
+            mEvents[i][j] += other.mEvents[i][j];
+    }
+
+    return *this;
+}
+
+string startPhaseTiming(bool isTimed, bool isCounted)
+{
+    THREAD_PHASE_TIMES = phaseTimes();
+    IS_THREAD_TIMED = IS_TIMING_BUILT && isTimed;
+    IS_THREAD_COUNTED = false;
+
+    //  the counters stay open once a thread has them, for the next world it runs
+    if (!IS_THREAD_TIMED || !isCounted)
+        return "";
+
+    if (!THREAD_PERF_COUNTERS.open())
+        return THREAD_PERF_COUNTERS.getError();
+
+    IS_THREAD_COUNTED = true;
+    return "";
+}
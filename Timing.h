@@ -0,0 +1,107 @@
+//  this file contains the phase timers, which show where the time of a generation goes
+
+#ifndef TIMING_H_INCLUDED
+#define TIMING_H_INCLUDED
+
+#include "PerfCounters.h"
+
+#include <chrono>
+#include <stdint.h>
+#include <string>
+
+using namespace std;
+
+/*
+The timers are only compiled in when WE_TIMING is defined ('make TIMING=1'). Otherwise TIME_PHASE() expands to nothing
+and the timing setting is ignored, so a normal build pays nothing for them.
+
+Each thread adds the time of its phases to accumulators of its own, so worlds run side by side (by a sweep) never share
+counters. A world works out what a generation spent by taking the difference of its thread's accumulators across it.
+
+When hardware counters are asked for as well, each timer also reads its thread's perfCounters as it starts and stops,
+so every phase gets its share of the cycles, instructions, cache misses and branch misses. A read is a system call, so
+this costs far more than the timing alone, and the phases that run many times briefly (sampling above all) look slower.
+*/
+
+//  the parts of a generation that are timed
+enum timingPhase {PHASE_SAMPLING, PHASE_SCORING, PHASE_SORTING, PHASE_CROSSOVER, PHASE_RECORDING, PHASE_AVERAGES, NUM_PHASES};
+const char * const PHASE_NAMES[NUM_PHASES] = {"sampling", "scoring", "sorting", "crossover", "recording", "averages"};
+
+//  time spent in each phase and the number of times it ran (for scoring, the clocks scored; for crossover, the children bred)
+struct phaseTimes
+{
+    int64_t mNanoseconds[NUM_PHASES];
+    int64_t mCounts[NUM_PHASES];
+
+    //  hardware events counted in each phase, in the order of PERF_COUNTER_NAMES (all 0 unless counters were used)
+    int64_t mEvents[NUM_PHASES][NUM_PERF_COUNTERS];
+
+    //  difference of two readings of the accumulators
+    phaseTimes operator-(const phaseTimes & earlier) const;
+    phaseTimes & operator+=(const phaseTimes & other);
+};
+
+#ifdef WE_TIMING
+const bool IS_TIMING_BUILT = true;
+#else
+const bool IS_TIMING_BUILT = false;
+#endif
+
+//  the calling thread's accumulators, whether its timers are running and reading its counters, and the counters
+extern thread_local phaseTimes THREAD_PHASE_TIMES;
+extern thread_local bool IS_THREAD_TIMED;
+extern thread_local bool IS_THREAD_COUNTED;
+extern thread_local perfCounters THREAD_PERF_COUNTERS;
+
+//  starts the accumulators of the calling thread from zero and turns its timers, and their counters, on or off;
+//  returns why the counters couldn't be used when they were asked for (the timers run without them), or an empty string
+string startPhaseTiming(bool isTimed, bool isCounted = false);
+
+//  adds the time from its construction to its destruction to a phase, if the thread's timers are on
+class phaseTimer
+{
+private:
+
+    int mPhase;
+    chrono::steady_clock::time_point mStartTime;
+    int64_t mStartEvents[NUM_PERF_COUNTERS];
+
+public:
+
+    phaseTimer(timingPhase phase)
+    {
+        mPhase = IS_THREAD_TIMED ? phase : -1;
+        if (mPhase < 0)
+            return;
+
+        if (IS_THREAD_COUNTED)
+            THREAD_PERF_COUNTERS.read(mStartEvents);
+        mStartTime = chrono::steady_clock::now();
+    };
+
+    ~phaseTimer()
+    {
+        if (mPhase < 0)
+            return;
+
+        THREAD_PHASE_TIMES.mNanoseconds[mPhase] += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - mStartTime).count();
+        THREAD_PHASE_TIMES.mCounts[mPhase]++;
+
+        if (IS_THREAD_COUNTED)
+        {
+            int64_t events[NUM_PERF_COUNTERS];
+            THREAD_PERF_COUNTERS.read(events);
+            for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+                THREAD_PHASE_TIMES.mEvents[mPhase][i] += events[i] - mStartEvents[i];
+        }
+    };
+};
+
+//  times the rest of the enclosing scope (one per scope)
+#ifdef WE_TIMING
+#define TIME_PHASE(phase) phaseTimer scopeTimer(phase)
+#else
+#define TIME_PHASE(phase)
+#endif
+
+#endif // TIMING_H_INCLUDED
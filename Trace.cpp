@@ -0,0 +1,371 @@
+//  this file defines the offspring trace
+#include "Trace.h"
+
+#include <cstring>
+#include <stdint.h>
+#include <unistd.h>
+#include <zlib.h>
+
+using namespace std;
+
+//  two pieces are the same if they'd make the same clock
+static bool isSamePiece(const pieceGene & a, const pieceGene & b)
+{
+    return a.mPieceType == b.mPieceType && a.mNumTeeth == b.mNumTeeth && a.mPendulumLength == b.mPendulumLength;
+}
+
+//  numbers are written a byte at a time, lowest first, so a trace reads the same on any machine
+static void putBytes(char * bytes, uint64_t value, int size)
+{
+    for (int i = 0; i < size; i++)
+        bytes[i] = (char)(value >> (8 * i));
+}
+
+static uint64_t getBytes(const char * bytes, int size)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < size; i++)
+        value |= (uint64_t)(unsigned char)bytes[i] << (8 * i);
+
+    return value;
+}
+
+traceWriter::traceWriter()
+{
+    mNumCells = 0;
+    mLastSlot = -1;
+    mWriter = NULL;
+}
+
+traceWriter::~traceWriter()
+{
+    close();
+}
+
+bool traceWriter::open(string path, int genomeSize, int populationSize, bool isGenerational)
+{
+    mFile.open(path.c_str(), ios::binary | ios::trunc);
+    if (!mFile)
+        return false;
+
+    mNumCells = genomeSize * genomeSize;
+    mLastSlot = -1;
+
+    uint32_t values[4] = {(uint32_t)TRACE_VERSION, (uint32_t)genomeSize, (uint32_t)populationSize, (uint32_t)isGenerational};
+    char header[sizeof(values)];
+    for (int i = 0; i < 4; i++)
+        putBytes(header + 4 * i, values[i], 4);
+
+    mFile.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    mFile.write(header, sizeof(header));
+
+    return (bool)mFile;
+}
+
+bool traceWriter::reopen(string path, int genomeSize, long fileSize)
+{
+    if (truncate(path.c_str(), fileSize) != 0)
+        return false;
+
+    mFile.open(path.c_str(), ios::binary | ios::app);
+    if (!mFile)
+        return false;
+
+    mNumCells = genomeSize * genomeSize;
+    mLastSlot = -1;
+
+    return true;
+}
+
+void traceWriter::addVarint(unsigned long value)
+{
+    //  seven bits at a time, the high bit set on every byte but the last
+    while (value >= 0x80)
+    {
+        mBlock += (char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    mBlock += (char)value;
+}
+
+void traceWriter::addSigned(long value)
+{
+    //  zigzag encoding keeps small negative numbers small
+    addVarint(((unsigned long)value << 1) ^ (unsigned long)(value >> (sizeof(long) * 8 - 1)));
+}
+
+void traceWriter::addDouble(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    char bytes[sizeof(bits)];
+    putBytes(bytes, bits, sizeof(bytes));
+    mBlock.append(bytes, sizeof(bytes));
+}
+
+void traceWriter::addPiece(const pieceGene & gene)
+{
+    mBlock += (char)gene.mPieceType;
+
+    if (gene.mPieceType == PTYPE_GEAR)
+        addVarint(gene.mNumTeeth);
+    else if (gene.mPieceType == PTYPE_PENDULUM)
+        addDouble(gene.mPendulumLength);
+}
+
+void traceWriter::addClock(const pieceGene * genome, double score)
+{
+    mBlock += (char)TRACE_CLOCK;
+    for (int i = 0; i < mNumCells; i++)
+        addPiece(genome[i]);
+    addDouble(score);
+
+    if (mBlock.size() >= TRACE_BLOCK_SIZE)
+        flush();
+}
+
+void traceWriter::addGeneration(int generation)
+{
+    mBlock += (char)TRACE_GENERATION;
+    addVarint(generation);
+}
+
+void traceWriter::addChild(int parent1, int parent2, int slot, const pieceGene * parentGenome, const pieceGene * childGenome, double score)
+{
+    mBlock += (char)TRACE_CHILD;
+    addVarint(parent1);
+    addVarint(parent2);
+    addSigned((long)slot - (mLastSlot + 1));
+    mLastSlot = slot;
+
+    int numChanged = 0;
+    for (int i = 0; i < mNumCells; i++)
+        numChanged += !isSamePiece(parentGenome[i], childGenome[i]);
+    addVarint(numChanged);
+
+    //  each changed piece is placed by its gap from the last one
+    int lastCell = -1;
+    for (int i = 0; i < mNumCells; i++)
+        if (!isSamePiece(parentGenome[i], childGenome[i]))
+        {
+            addVarint(i - lastCell - 1);
+            addPiece(childGenome[i]);
+            lastCell = i;
+        }
+
+    addDouble(score);
+
+    if (mBlock.size() >= TRACE_BLOCK_SIZE)
+        flush();
+}
+
+void traceWriter::flush()
+{
+    if (!mFile.is_open() || mBlock.empty())
+        return;
+
+    uLongf compressedSize = compressBound(mBlock.size());
+    size_t start = mCompressed.size();
+    mCompressed.resize(start + 2 * sizeof(uint32_t) + compressedSize);
+
+    char * data = &mCompressed[start + 2 * sizeof(uint32_t)];
+    if (compress2((Bytef *)data, &compressedSize, (const Bytef *)mBlock.data(), mBlock.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+    {
+        mCompressed.resize(start);
+        return;
+    }
+
+    putBytes(&mCompressed[start], mBlock.size(), sizeof(uint32_t));
+    putBytes(&mCompressed[start + sizeof(uint32_t)], compressedSize, sizeof(uint32_t));
+    mCompressed.resize(start + 2 * sizeof(uint32_t) + compressedSize);
+
+    if (mWriter != NULL)
+    {
+        mWriter->write(mFile, mCompressed);
+        mWriter->flush(mFile);
+    }
+    else
+    {
+        mFile.write(mCompressed.data(), mCompressed.size());
+        mFile.flush();
+        mCompressed.clear();
+    }
+
+    //  blocks start afresh, so each one can be read without the ones before it
+    mBlock.clear();
+    mLastSlot = -1;
+}
+
+void traceWriter::close()
+{
+    if (!mFile.is_open())
+        return;
+
+    flush();
+    mFile.close();
+}
+
+traceReader::traceReader()
+{
+    mGenomeSize = 0;
+    mPopulationSize = 0;
+    mIsGenerational = false;
+    mPosition = 0;
+    mLastSlot = -1;
+}
+
+bool traceReader::open(string path)
+{
+    mFile.open(path.c_str(), ios::binary);
+    if (!mFile)
+        return false;
+
+    char magic[sizeof(TRACE_MAGIC)];
+    char header[4 * sizeof(uint32_t)];
+    mFile.read(magic, sizeof(magic));
+    mFile.read(header, sizeof(header));
+
+    if (!mFile || memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0 || getBytes(header, 4) != (uint32_t)TRACE_VERSION)
+        return false;
+
+    mGenomeSize = (int)getBytes(header + 4, 4);
+    mPopulationSize = (int)getBytes(header + 8, 4);
+    mIsGenerational = (getBytes(header + 12, 4) != 0);
+
+    return true;
+}
+
+bool traceReader::readBlock()
+{
+    char sizeBytes[2 * sizeof(uint32_t)];
+    if (!mFile.read(sizeBytes, sizeof(sizeBytes)))
+        return false;
+
+    uint32_t sizes[2] = {(uint32_t)getBytes(sizeBytes, 4), (uint32_t)getBytes(sizeBytes + 4, 4)};
+
+    mCompressed.resize(sizes[1]);
+    if (!mFile.read(&mCompressed[0], sizes[1]))
+        return false;
+
+    uLongf blockSize = sizes[0];
+    mBlock.resize(blockSize);
+    if (uncompress((Bytef *)&mBlock[0], &blockSize, (const Bytef *)mCompressed.data(), mCompressed.size()) != Z_OK || blockSize != sizes[0])
+        return false;
+
+    mPosition = 0;
+    mLastSlot = -1;
+
+    return true;
+}
+
+bool traceReader::readVarint(unsigned long & value)
+{
+    value = 0;
+
+    for (int shift = 0; mPosition < mBlock.size(); shift += 7)
+    {
+        unsigned char byte = mBlock[mPosition++];
+        value |= (unsigned long)(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+bool traceReader::readDouble(double & value)
+{
+    if (mPosition + sizeof(value) > mBlock.size())
+        return false;
+
+    uint64_t bits = getBytes(&mBlock[mPosition], sizeof(bits));
+    memcpy(&value, &bits, sizeof(value));
+    mPosition += sizeof(value);
+
+    return true;
+}
+
+bool traceReader::readPiece(pieceGene & gene)
+{
+    if (mPosition >= mBlock.size())
+        return false;
+
+    gene = NULL_GENE;
+    gene.mPieceType = (unsigned char)mBlock[mPosition++];
+
+    unsigned long numTeeth;
+    if (gene.mPieceType == PTYPE_GEAR)
+    {
+        if (!readVarint(numTeeth))
+            return false;
+        gene.mNumTeeth = (int)numTeeth;
+    }
+    else if (gene.mPieceType == PTYPE_PENDULUM)
+        return readDouble(gene.mPendulumLength);
+
+    return true;
+}
+
+bool traceReader::readRecord(traceRecord & record)
+{
+    if (mPosition >= mBlock.size() && !readBlock())
+        return false;
+
+    record.mTag = (unsigned char)mBlock[mPosition++];
+    record.mCells.clear();
+    record.mPieces.clear();
+
+    unsigned long value;
+    pieceGene gene;
+
+    if (record.mTag == TRACE_CLOCK)
+    {
+        for (int i = 0; i < mGenomeSize * mGenomeSize; i++)
+        {
+            if (!readPiece(gene))
+                return false;
+            record.mCells.push_back(i);
+            record.mPieces.push_back(gene);
+        }
+
+        return readDouble(record.mScore);
+    }
+
+    if (record.mTag == TRACE_GENERATION)
+    {
+        if (!readVarint(value))
+            return false;
+        record.mGeneration = (int)value;
+
+        return true;
+    }
+
+    if (record.mTag != TRACE_CHILD)
+        return false;
+
+    unsigned long parent1, parent2, slotGap, numChanged;
+    if (!readVarint(parent1) || !readVarint(parent2) || !readVarint(slotGap) || !readVarint(numChanged))
+        return false;
+
+    //  undo the zigzag encoding of the slot
+    long gap = (long)(slotGap >> 1) ^ -(long)(slotGap & 1);
+    record.mParent1 = (int)parent1;
+    record.mParent2 = (int)parent2;
+    record.mSlot = (int)(mLastSlot + 1 + gap);
+    mLastSlot = record.mSlot;
+
+    int cell = -1;
+    for (unsigned long i = 0; i < numChanged; i++)
+    {
+        if (!readVarint(value) || !readPiece(gene))
+            return false;
+
+        cell += (int)value + 1;
+        record.mCells.push_back(cell);
+        record.mPieces.push_back(gene);
+    }
+
+    return readDouble(record.mScore);
+}
@@ -0,0 +1,157 @@
+//  this file contains the offspring trace, a compressed record of every clock born in a simulation, and its reader
+
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+#include "Clock.h"
+#include "Writer.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+LAYOUT OF A TRACE FILE (all numbers little-endian, whichever machine writes it):
+
+    header   "WETRACE1", uint32 version, uint32 genome size, uint32 population size, uint32 1 if whole generations are
+             replaced at once (roulette and rank selection) or 0 if each child replaces one clock (tournaments)
+    blocks   uint32 size before compression, uint32 size after, then the records compressed with zlib
+
+Each block can be read on its own. Its records are a tag byte followed by:
+
+    TRACE_CLOCK        a clock of the first generation: every piece, then its score
+    TRACE_GENERATION   varint number of the generation whose children follow
+    TRACE_CHILD        varint first parent, varint second parent, zigzag varint slot minus (last slot + 1),
+                       varint number of pieces that differ from the first parent, those pieces, then the child's score
+
+A piece is a uint8 type, then a varint number of teeth for a gear or a float64 length for a pendulum. Pieces that
+differ from the parent are each led by a varint gap from the last one. Scores are float64, and are what a clock scores
+the first time it's evaluated. Parents are slots of the population as it was before the child was born; when whole
+generations are replaced, the children are only put in place once the next generation starts (or the trace ends).
+*/
+
+//  fixed parts of the file
+const char TRACE_MAGIC[8] = {'W', 'E', 'T', 'R', 'A', 'C', 'E', '1'};
+const int TRACE_VERSION = 1;
+
+//  record tags
+const int TRACE_CLOCK = 0;
+const int TRACE_GENERATION = 1;
+const int TRACE_CHILD = 2;
+
+//  records are gathered until a block grows to this size before being compressed
+const int TRACE_BLOCK_SIZE = 1 << 18;
+
+//  writes the trace, compressing it block by block
+class traceWriter
+{
+private:
+
+    ofstream mFile;
+    int mNumCells;
+
+    //  records of the block being gathered, and the block once compressed
+    string mBlock;
+    string mCompressed;
+
+    //  slot of the last child in the block, which the next one is counted from
+    int mLastSlot;
+
+    //  background writer that finished blocks are handed to (NULL writes them directly)
+    asyncWriter * mWriter;
+
+    //  appends a varint, a zigzag varint, a raw value and a piece to the block
+    void addVarint(unsigned long value);
+    void addSigned(long value);
+    void addDouble(double value);
+    void addPiece(const pieceGene & gene);
+
+public:
+
+    traceWriter();
+    ~traceWriter();
+
+    //  creates the file and writes the header; returns false if it can't be opened
+    bool open(string path, int genomeSize, int populationSize, bool isGenerational);
+
+    //  reopens a file written before, cutting it back to 'fileSize' bytes and appending from there
+    bool reopen(string path, int genomeSize, long fileSize);
+
+    bool isOpen() {return mFile.is_open();};
+
+    //  hands finished blocks to a background writer instead of writing them directly
+    void setWriter(asyncWriter * writer) {mWriter = writer;};
+
+    //  records a clock of the first generation
+    void addClock(const pieceGene * genome, double score);
+
+    //  records the start of a generation
+    void addGeneration(int generation);
+
+    //  records a child born into 'slot' from two parents, given the genome of the first parent and of the child
+    void addChild(int parent1, int parent2, int slot, const pieceGene * parentGenome, const pieceGene * childGenome, double score);
+
+    //  compresses and writes the records gathered so far as a block
+    void flush();
+
+    //  writes the last block and closes the file
+    void close();
+};
+
+//  one record read back from a trace
+struct traceRecord
+{
+    int mTag;
+    int mGeneration;
+    int mParent1;
+    int mParent2;
+    int mSlot;
+
+    //  the pieces of the clock (TRACE_CLOCK), or the cells and pieces that differ from the first parent (TRACE_CHILD)
+    vector<int> mCells;
+    vector<pieceGene> mPieces;
+
+    double mScore;
+};
+
+//  reads a trace record by record
+class traceReader
+{
+private:
+
+    ifstream mFile;
+    int mGenomeSize;
+    int mPopulationSize;
+    bool mIsGenerational;
+
+    //  the block being read, and how far into it
+    string mBlock;
+    string mCompressed;
+    size_t mPosition;
+    int mLastSlot;
+
+    //  decompresses the next block; returns false at the end of the file (or a block cut short)
+    bool readBlock();
+
+    //  read from the block, returning false if it runs out
+    bool readVarint(unsigned long & value);
+    bool readDouble(double & value);
+    bool readPiece(pieceGene & gene);
+
+public:
+
+    traceReader();
+
+    //  opens a trace and reads its header; returns false if it isn't a trace
+    bool open(string path);
+
+    int getGenomeSize() {return mGenomeSize;};
+    int getPopulationSize() {return mPopulationSize;};
+    bool isGenerational() {return mIsGenerational;};
+
+    //  reads the next record; returns false at the end of the trace
+    bool readRecord(traceRecord & record);
+};
+
+#endif // TRACE_H_INCLUDED
@@ -0,0 +1,150 @@
+//  this file is a small tool that rebuilds a population from an offspring trace and prints it
+#include "GenomeFile.h"
+#include "Trace.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+//  puts the children of the last generation read in place, when whole generations are replaced at once
+static void commitGeneration(vector<pieceGene> & population, vector<pieceGene> & next, vector<double> & scores, vector<double> & nextScores, bool & isPending)
+{
+    if (!isPending)
+        return;
+
+    population.swap(next);
+    scores.swap(nextScores);
+    next = population;
+    nextScores = scores;
+    isPending = false;
+}
+
+int main(int argc, char * argv[])
+{
+    //  the population can also be saved as a binary genome file, for scoregenomes
+    string genomePath;
+    if (argc > 1 && string(argv[argc - 1]).compare(0, 10, "--genomes=") == 0)
+        genomePath = string(argv[--argc]).substr(10);
+
+    if (argc != 2 && argc != 3)
+    {
+        cerr << "usage: tracereplay <file>_trace.bin [generation] [--genomes=file]" << endl;
+        return 1;
+    }
+
+    traceReader reader;
+    if (!reader.open(argv[1]))
+    {
+        cerr << "Can't read trace file '" << argv[1] << "'" << endl;
+        return 1;
+    }
+
+    //  the last generation in the trace is rebuilt unless another is asked for
+    int targetGeneration = (argc == 3) ? atoi(argv[2]) : -1;
+
+    int genomeSize = reader.getGenomeSize();
+    int numCells = genomeSize * genomeSize;
+    int populationSize = reader.getPopulationSize();
+    bool isGenerational = reader.isGenerational();
+
+    vector<pieceGene> population(populationSize * numCells, NULL_GENE);
+    vector<double> scores(populationSize, 0);
+    vector<pieceGene> next;
+    vector<double> nextScores;
+    bool isPending = false;
+
+    clock_t startTime = clock();
+    int generation = 0;
+    int numClocks = 0;
+    traceRecord record;
+
+    while (reader.readRecord(record))
+    {
+        if (record.mTag == TRACE_CLOCK)
+        {
+            if (numClocks >= populationSize)
+                break;
+
+            for (int i = 0; i < numCells; i++)
+                population[numClocks * numCells + i] = record.mPieces[i];
+            scores[numClocks++] = record.mScore;
+        }
+        else if (record.mTag == TRACE_GENERATION)
+        {
+            if (isGenerational)
+                commitGeneration(population, next, scores, nextScores, isPending);
+
+            if (targetGeneration >= 0 && record.mGeneration > targetGeneration)
+                break;
+            generation = record.mGeneration;
+
+            if (isGenerational && next.empty())
+            {
+                next = population;
+                nextScores = scores;
+            }
+        }
+        else
+        {
+            if (record.mSlot < 0 || record.mSlot >= populationSize || record.mParent1 >= populationSize)
+            {
+                cerr << "Trace file '" << argv[1] << "' has a child out of range in generation " << generation << endl;
+                return 1;
+            }
+
+            //  a child is its first parent with the pieces that differ put over it
+            vector<pieceGene> & target = isGenerational ? next : population;
+            vector<double> & targetScores = isGenerational ? nextScores : scores;
+
+            pieceGene * child = &target[record.mSlot * numCells];
+            if (record.mParent1 != record.mSlot || isGenerational)
+                copy(&population[record.mParent1 * numCells], &population[record.mParent1 * numCells] + numCells, child);
+            for (int i = 0; i < (signed int)record.mCells.size(); i++)
+                child[record.mCells[i]] = record.mPieces[i];
+
+            targetScores[record.mSlot] = record.mScore;
+            isPending = true;
+        }
+    }
+
+    if (isGenerational)
+        commitGeneration(population, next, scores, nextScores, isPending);
+
+    if (targetGeneration > generation)
+        cerr << "The trace ends at generation " << generation << endl;
+
+    double seconds = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+    fprintf(stderr, "Rebuilt generation %d of %d clocks in %.3f seconds\n", generation, populationSize, seconds);
+
+    if (!genomePath.empty())
+    {
+        genomeWriter writer;
+        bool isWritten = writer.open(genomePath, genomeSize);
+        for (int i = 0; i < populationSize && isWritten; i++)
+            writer.add(&population[i * numCells]);
+
+        if (!writer.close() || !isWritten)
+        {
+            cerr << "Can't write genome file '" << genomePath << "'" << endl;
+            return 1;
+        }
+    }
+
+    //  each clock is printed the way the genome file shows them
+    const char PIECE_LETTERS[] = {' ', 'E', 'M', 'G', 'H', 'P'};
+
+    printf("# generation %d\n", generation);
+    for (int i = 0; i < populationSize; i++)
+    {
+        printf("clock %d, score %.17g\n", i, scores[i]);
+
+        for (int x = 0; x < genomeSize; x++)
+        {
+            for (int y = 0; y < genomeSize; y++)
+                printf("%c", PIECE_LETTERS[population[i * numCells + x * genomeSize + y].mPieceType]);
+            printf("\n");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+//  this file defines the background writer
+#include "Writer.h"
+
+#include <chrono>
+
+using namespace std;
+
+asyncWriter::asyncWriter() : mQueue(WRITER_QUEUE_SLOTS)
+{
+    mHead.store(0);
+    mTail.store(0);
+    mNumStalls = 0;
+    mIsRunning.store(false);
+    mIsSleeping.store(false);
+}
+
+asyncWriter::~asyncWriter()
+{
+    stop();
+}
+
+void asyncWriter::start()
+{
+    if (mIsRunning.load())
+        return;
+
+    mIsRunning.store(true);
+    mThread = thread(&asyncWriter::runWriter, this);
+}
+
+void asyncWriter::stop()
+{
+    if (!mIsRunning.load())
+        return;
+
+    //  the writer empties the queue before it sees that it has been stopped
+    {
+        lock_guard<mutex> guard(mSleepLock);
+        mIsRunning.store(false);
+    }
+    mWake.notify_one();
+    mThread.join();
+}
+
+void asyncWriter::push(ostream & target, bool isFlush, string & data)
+{
+    unsigned long tail = mTail.load(memory_order_relaxed);
+
+    //  backpressure: the simulation can only get a queue's length ahead of the writer
+    while (tail - mHead.load(memory_order_acquire) >= (unsigned long)WRITER_QUEUE_SLOTS)
+    {
+        mNumStalls++;
+        this_thread::yield();
+    }
+
+    //  swapping hands over the bytes and gives back a written record's storage to fill next time
+    writeRecord & record = mQueue[tail % WRITER_QUEUE_SLOTS];
+    record.mTarget = &target;
+    record.mIsFlush = isFlush;
+    record.mData.swap(data);
+    data.clear();
+
+    mTail.store(tail + 1, memory_order_release);
+
+    if (mIsSleeping.load())
+        mWake.notify_one();
+}
+
+void asyncWriter::write(ostream & target, string & data)
+{
+    if (!data.empty())
+        push(target, false, data);
+}
+
+void asyncWriter::flush(ostream & target)
+{
+    string empty;
+    push(target, true, empty);
+}
+
+void asyncWriter::drain()
+{
+    while (mHead.load(memory_order_acquire) != mTail.load(memory_order_relaxed))
+        this_thread::yield();
+}
+
+void asyncWriter::runWriter()
+{
+    while (true)
+    {
+        unsigned long head = mHead.load(memory_order_relaxed);
+
+        if (head == mTail.load(memory_order_acquire))
+        {
+            if (!mIsRunning.load())
+                return;
+
+            //  nothing to do, so sleep until woken (the timeout covers a wake-up sent just before sleeping)
+            unique_lock<mutex> guard(mSleepLock);
+            mIsSleeping.store(true);
+            if (head == mTail.load(memory_order_acquire) && mIsRunning.load())
+                mWake.wait_for(guard, chrono::milliseconds(1));
+            mIsSleeping.store(false);
+            continue;
+        }
+
+        writeRecord & record = mQueue[head % WRITER_QUEUE_SLOTS];
+        if (record.mIsFlush)
+            record.mTarget->flush();
+        else
+            record.mTarget->write(record.mData.data(), record.mData.size());
+
+        //  the storage is kept for the producer to reuse
+        record.mData.clear();
+        mHead.store(head + 1, memory_order_release);
+    }
+}
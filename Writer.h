@@ -0,0 +1,85 @@
+//  this file contains the background writer, which takes file and console output off the thread running the simulation
+
+#ifndef WRITER_H_INCLUDED
+#define WRITER_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+//  number of records that can wait in the queue before the simulation is held back
+const int WRITER_QUEUE_SLOTS = 256;
+
+//  batches of text are handed to the writer once they grow past this size
+const int WRITER_BATCH_SIZE = 1 << 16;
+
+//  writes preformatted text and binary records on a thread of its own
+//  only one thread may queue records (single producer), and the writer thread is the only consumer
+class asyncWriter
+{
+private:
+
+    //  one queued record: bytes to write to a stream, or a request to flush it
+    struct writeRecord
+    {
+        ostream * mTarget;
+        bool mIsFlush;
+        string mData;
+    };
+
+    vector<writeRecord> mQueue;
+
+    //  next record to write (moved by the writer thread) and next free slot (moved by the producer), on separate cache lines
+    alignas(64) atomic<unsigned long> mHead;
+    alignas(64) atomic<unsigned long> mTail;
+
+    //  times the producer found the queue full and had to wait for the writer
+    alignas(64) unsigned long mNumStalls;
+
+    thread mThread;
+    atomic<bool> mIsRunning;
+
+    //  lets the writer sleep while the queue is empty
+    mutex mSleepLock;
+    condition_variable mWake;
+    atomic<bool> mIsSleeping;
+
+    //  the loop the writer thread runs
+    void runWriter();
+
+    //  waits for a free slot and fills it
+    void push(ostream & target, bool isFlush, string & data);
+
+    asyncWriter (const asyncWriter &);
+    asyncWriter & operator= (const asyncWriter &);
+
+public:
+
+    asyncWriter();
+    ~asyncWriter();
+
+    //  starts and stops the writer thread; stopping writes out everything still queued first
+    void start();
+    void stop();
+
+    bool isRunning() {return mIsRunning.load();};
+
+    //  queues the contents of 'data' to be written to 'target', leaving 'data' empty (its old storage is reused)
+    void write(ostream & target, string & data);
+
+    //  queues a flush of 'target' after everything queued before it
+    void flush(ostream & target);
+
+    //  waits until everything queued so far has been written
+    void drain();
+
+    unsigned long getNumStalls() {return mNumStalls;};
+};
+
+#endif // WRITER_H_INCLUDED
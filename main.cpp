@@ -23,36 +23,51 @@ RULES FOR PIECE CONNECTION:
 
 #include "Evolve.h"
 #include "Interface.h"
+#include "Jobs.h"
+#include "Replay.h"
+#include "Sweep.h"
 
-int main()
+int main(int argc, char * argv[])
 {
-    //  get simulation info from user
-    varData settings;
-    settings = runCLI();
+    //  'watchingevolution sweep name=values ...' runs a parameter sweep instead of the console
+    if (argc > 1 && string(argv[1]) == "sweep")
+        return runSweep(argc - 2, argv + 2);
+
+    //  'watchingevolution jobs <file>' runs a job file
+    if (argc > 1 && string(argv[1]) == "jobs")
+        return runJobFile(argc - 2, argv + 2);
+
+    //  'watchingevolution replay' times the seeded replay scenarios
+    if (argc > 1 && string(argv[1]) == "replay")
+        return runReplay(argc - 2, argv + 2);
 
-    // check for manual user quit
-    if (settings.mQuitFlag)
+    if (argc > 1 && (string(argv[1]) == "--help" || string(argv[1]) == "help"))
     {
-        cout << endl << "User quit manually!" << endl;
+        writeFlagHelp();
         return 0;
     }
 
-    //  run the simulations
-    for (int i = 0; i < settings.mSimTimes; i++)
+    //  get simulation info from flags, or from the user if there aren't any
+    varData settings;
+    if (argc > 1)
     {
-    	//	make the world
-        world simulation (settings);
-
-        //	initialize clocks
-        simulation.initClocks();
-
-        //	mate them
-        simulation.mateClocks();
+        if (!readFlags(argc - 1, argv + 1, settings))
+            return 1;
+    }
+    else
+    {
+        settings = runCLI();
 
-        //	close output file
-        simulation.fout.close();
-        simulation.gout.close();
+        // check for manual user quit
+        if (settings.mQuitFlag)
+        {
+            cout << endl << "User quit manually!" << endl;
+            return 0;
+        }
     }
 
+    //  run the simulations
+    runSimulations(settings, 1);
+
     return 0;
 }